@@ -0,0 +1,505 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "assembler.h"
+#include "../stg_00_preprocessor/preprocessor.h"
+#include "../stg_01_first_pass/first_pass.h"
+#include "../stg_02_second_pass/second_pass.h"
+#include "../common/cache/build_cache.h"
+#include "../common/encoding/binary_object.h"
+#include "../common/log/log.h"
+
+/*-----------------------------------------------------------
+    Assembler driver
+    Runs the pre-assembler, both passes and the output stage
+    on a single source file, and reports the result
+------------------------------------------------------------*/
+
+/* The pre-assembler running on its own thread */
+typedef struct
+{
+    AssemblerContext *ctx;
+    StatusInfo *status_info; /* kept apart from the first pass's log until both are done */
+    int result;
+} PreprocessorThread;
+
+static void *preprocessor_main(void *arg)
+{
+    PreprocessorThread *pre = (PreprocessorThread *)arg;
+
+    pre->result = preprocess_source(pre->ctx, pre->status_info);
+    line_ring_close(pre->ctx->line_ring);
+    return NULL;
+}
+
+/* Runs the pre-assembler, then the first pass on its output */
+static AssemblyResult run_front_end(AssemblerContext *ctx)
+{
+    if (run_pre_assembler(ctx) != 0)
+        return ASSEMBLY_FAILED_IO;
+
+    if (ctx->status_info->error_count > 0)
+        return ASSEMBLY_FAILED_PRE_ASSEMBLER;
+
+    run_first_pass(ctx);
+    return ASSEMBLY_OK;
+}
+
+/*
+ * Same as run_front_end, but the pre-assembler runs on its own thread and
+ * the first pass parses its lines as they arrive through a bounded ring.
+ * The diagnostics end up exactly as if the stages had run back to back.
+ * Falls back to run_front_end if the pipeline cannot be set up.
+ */
+static AssemblyResult run_front_end_pipelined(AssemblerContext *ctx)
+{
+    LineRing ring;
+    PreprocessorThread pre;
+    pthread_t thread;
+    int pre_failed;
+
+    pre.ctx = ctx;
+    pre.result = 0;
+    pre.status_info = create_status_info();
+    if (!pre.status_info)
+        return run_front_end(ctx);
+    pre.status_info->echo = ctx->status_info->echo;
+
+    if (line_ring_init(&ring, LINE_RING_CAPACITY) != 0)
+    {
+        free_status_info(pre.status_info);
+        return run_front_end(ctx);
+    }
+
+    ctx->line_ring = &ring;
+    if (pthread_create(&thread, NULL, preprocessor_main, &pre) != 0)
+    {
+        ctx->line_ring = NULL;
+        line_ring_destroy(&ring);
+        free_status_info(pre.status_info);
+        return run_front_end(ctx);
+    }
+
+    run_first_pass(ctx);
+
+    /* the first pass may stop early; let the pre-assembler finish without blocking */
+    line_ring_cancel(&ring);
+    pthread_join(thread, NULL);
+    ctx->line_ring = NULL;
+    line_ring_destroy(&ring);
+
+    /*
+     * Pre-assembler diagnostics come first. When it failed, the first pass
+     * would not have run at all, so its diagnostics are dropped.
+     */
+    pre_failed = pre.result != 0 || pre.status_info->error_count > 0;
+    if (!pre_failed)
+        append_status_info(pre.status_info, ctx->status_info);
+    reset_status_info(ctx->status_info);
+    append_status_info(ctx->status_info, pre.status_info);
+    free_status_info(pre.status_info);
+
+    if (pre.result != 0)
+        return ASSEMBLY_FAILED_IO;
+    if (pre_failed)
+        return ASSEMBLY_FAILED_PRE_ASSEMBLER;
+    return ASSEMBLY_OK;
+}
+
+/*
+ * Runs all assembler stages on the source already attached to the context.
+ * The generated files are left in ctx->object_file, entries_file and
+ * externals_file; nothing is written to disk here.
+ */
+AssemblyResult assemble_source(AssemblerContext *ctx)
+{
+    StatusInfo *status_info = ctx->status_info;
+    TableNode *current;
+    SymbolInfo *curr_info;
+    AssemblyResult result;
+    int ICF;
+
+    /* Pre-assembler and first pass, back to back or overlapped */
+    result = ctx->options.pipeline ? run_front_end_pipelined(ctx) : run_front_end(ctx);
+    if (result != ASSEMBLY_OK)
+        return result;
+
+    /* update data memory locations */
+    current = ctx->symbol_table->head;
+    ICF = ctx->IC;
+    while (current)
+    {
+        curr_info = (SymbolInfo *)current->data;
+        if (curr_info->type == SYMBOL_DATA)
+        {
+            curr_info->address += ICF;
+            LOG_TRACE(LOG_FIRST_PASS, ("%s\n--> moving data symbol to data image\nnew address: %d\n\n",
+                                       current->key, curr_info->address));
+        }
+
+        current = current->next;
+    }
+
+    /* CHECK ERROR LOG; after a failed allocation the log itself may be incomplete */
+    if (status_info->is_out_of_memory)
+        return ASSEMBLY_FAILED_IO;
+    if (status_info->error_count > 0)
+        return ASSEMBLY_FAILED_FIRST_PASS;
+
+    LOG_INFO(LOG_SECOND_PASS, ("\033[1;32m------------ Starting 2nd pass ------------\033[0m\n\n"));
+    run_second_pass(ctx);
+
+    /* CHECK ERROR LOG */
+    if (status_info->is_out_of_memory)
+        return ASSEMBLY_FAILED_IO;
+    if (status_info->error_count > 0)
+        return ASSEMBLY_FAILED_SECOND_PASS;
+
+    if (format_output_files(ctx) != 0)
+        return ASSEMBLY_FAILED_IO;
+
+    return ASSEMBLY_OK;
+}
+
+/* Files of a build cache entry, in the order used by restore/store */
+#define CACHE_OBJECT 0
+#define CACHE_ENTRIES 1
+#define CACHE_EXTERNALS 2
+#define CACHE_DIAGNOSTICS 3
+#define CACHE_FILE_COUNT 4
+
+static const char *cache_file_names[CACHE_FILE_COUNT] = {"object.ob", "entries.ent", "externals.ext", "diagnostics"};
+static const char *cache_file_extensions[CACHE_DIAGNOSTICS] = {".ob", ".ent", ".ext"};
+
+/*
+ * Puts the cached outputs of the current source in place and replays its
+ * warnings, as if every stage had run. Returns 0 on a hit.
+ */
+static int restore_from_cache(AssemblerContext *ctx, const char *key)
+{
+    const char *cache_dir = ctx->options.cache_dir;
+    char path[PATH_MAX];
+    TextBuffer diagnostics;
+    const char *entry;
+    int code, line_number;
+    int i, status;
+
+    if (!cache_has_entry(cache_dir, key))
+        return -1;
+
+    text_buffer_init(&diagnostics);
+    if (cache_read_file(cache_dir, key, cache_file_names[CACHE_DIAGNOSTICS], &diagnostics) < 0)
+    {
+        text_buffer_free(&diagnostics);
+        return -1;
+    }
+
+    for (i = CACHE_OBJECT; i < CACHE_DIAGNOSTICS; i++)
+    {
+        context_output_path(ctx, cache_file_extensions[i], path, sizeof(path));
+        status = cache_fetch_file(cache_dir, key, cache_file_names[i], path);
+
+        /* only the object file is mandatory */
+        if (status < 0 || (status > 0 && i == CACHE_OBJECT))
+        {
+            text_buffer_free(&diagnostics);
+            return -1;
+        }
+    }
+
+    /* one "<code> <line>" pair per line */
+    entry = diagnostics.data;
+    while (entry && *entry)
+    {
+        if (sscanf(entry, "%d %d", &code, &line_number) == 2)
+            write_error_log(ctx->status_info, (ErrorCode)code, line_number);
+        entry = strchr(entry, '\n');
+        if (entry)
+            entry++;
+    }
+    text_buffer_free(&diagnostics);
+
+    LOG_INFO(LOG_OUTPUT, ("♻️  Reused cached outputs for: %s\n", ctx->input_path));
+    return 0;
+}
+
+/* Stores the outputs and warnings of a successful assembly. Failures only cost a future miss */
+static void store_in_cache(AssemblerContext *ctx, const char *key)
+{
+    const TextBuffer *files[CACHE_FILE_COUNT];
+    TextBuffer diagnostics;
+    const StatusInfo *status_info = ctx->status_info;
+    int i;
+
+    text_buffer_init(&diagnostics);
+    for (i = 0; i < status_info->error_count + status_info->warning_count; i++)
+        text_buffer_printf(&diagnostics, "%d %d\n", (int)status_info->error_log[i].code,
+                           status_info->error_log[i].line_number);
+
+    files[CACHE_OBJECT] = &ctx->object_file;
+    files[CACHE_ENTRIES] = &ctx->entries_file;
+    files[CACHE_EXTERNALS] = &ctx->externals_file;
+    files[CACHE_DIAGNOSTICS] = &diagnostics;
+    if (cache_store_entry(ctx->options.cache_dir, key, cache_file_names, files, CACHE_FILE_COUNT) != 0)
+        LOG_WARNING(LOG_OUTPUT, ("Warning: could not store %s in the build cache\n", ctx->input_path));
+
+    text_buffer_free(&diagnostics);
+}
+
+/*
+ * Runs all assembler stages on a single input file and writes its outputs.
+ * The context must be empty (fresh or reset); the caller resets it afterwards.
+ * Nothing is reported here, see report_assembly_result.
+ */
+AssemblyResult assemble_file(AssemblerContext *ctx, const char *input_filename)
+{
+    AssemblyResult result;
+    char key[CACHE_KEY_LEN];
+    int use_cache;
+
+    if (context_set_input(ctx, input_filename) != 0)
+    {
+        fprintf(stderr, "❌ Failed to extract basename from: %s\n", input_filename);
+        return ASSEMBLY_FAILED_IO;
+    }
+
+    if (context_load_source(ctx) != 0)
+    {
+        fprintf(stderr, "❌ Cannot open file for reading: %s\n", input_filename);
+        return ASSEMBLY_FAILED_IO;
+    }
+
+    /* .am and .obj files are never cached, so --am and --binary always run every stage */
+    use_cache = ctx->options.cache_dir && !ctx->options.write_expanded_file && !ctx->options.write_binary_object;
+    if (use_cache)
+    {
+        cache_make_key(ctx->source, ctx->source_length, ASSEMBLER_VERSION, key, sizeof(key));
+        if (restore_from_cache(ctx, key) == 0)
+            return ASSEMBLY_OK;
+    }
+
+    result = assemble_source(ctx);
+    if (result == ASSEMBLY_OK && write_output_files(ctx) != 0)
+        return ASSEMBLY_FAILED_IO;
+
+    if (result == ASSEMBLY_OK && use_cache)
+        store_in_cache(ctx, key);
+
+    return result;
+}
+
+/* Prints the diagnostics of one assembled file, grouped under its name */
+void report_assembly_result(const char *input_filename, AssemblyResult result, StatusInfo *status_info)
+{
+    printf("\n📄 %s\n", input_filename);
+
+    switch (result)
+    {
+    case ASSEMBLY_OK:
+        print_errors(status_info);
+        break;
+    case ASSEMBLY_FAILED_IO:
+        printf("Could not process file\n");
+        break;
+    case ASSEMBLY_FAILED_PRE_ASSEMBLER:
+        print_errors(status_info);
+        printf("Did not pass preprocessor stage\n");
+        break;
+    case ASSEMBLY_FAILED_FIRST_PASS:
+        report_stage_errors(status_info, "first_pass");
+        break;
+    case ASSEMBLY_FAILED_SECOND_PASS:
+        report_stage_errors(status_info, "second_pass");
+        break;
+    }
+}
+
+/* Prints the error log of a file that failed the given stage */
+void report_stage_errors(StatusInfo *status_info, const char *stage_name)
+{
+    int i;
+
+    printf("Error count: %d\n", status_info->error_count);
+    printf("Warning count: %d\n", status_info->warning_count);
+    printf("Did not pass %s stage\n", stage_name);
+
+    for (i = 0; i < status_info->error_count + status_info->warning_count; i++)
+    {
+        if (status_info->error_log[i].sevirity == SEV_ERROR)
+        {
+            printf("\033[1;31mLine: %d: %s\033[0m\n",
+                   status_info->error_log[i].line_number,
+                   status_info->error_log[i].message); /* Red */
+        }
+        else if (status_info->error_log[i].sevirity == SEV_WARNING)
+        {
+            printf("\033[1;33mLine: %d: %s\033[0m\n",
+                   status_info->error_log[i].line_number,
+                   status_info->error_log[i].message); /* Yellow */
+        }
+        else
+        {
+            printf("Line: %d: %s\n",
+                   status_info->error_log[i].line_number,
+                   status_info->error_log[i].message);
+        }
+    }
+}
+
+#define OBJECT_HEADER_LEN 22 /* both counts right-aligned in 10 columns, a tab and a newline */
+#define SYMBOL_ROW_TAIL_LEN (1 + ADDRESS_DIGITS + 1) /* a tab, the address and a newline after the name */
+
+/* Appends "<name>\t<address>\n" to a .ent or .ext buffer. Returns 0 on success */
+static int append_symbol_row(TextBuffer *buffer, const char *name, int address)
+{
+    char tail[SYMBOL_ROW_TAIL_LEN + 1];
+
+    tail[0] = '\t';
+    addr_to_base4(address, tail + 1);
+    tail[SYMBOL_ROW_TAIL_LEN - 1] = '\n';
+    if (text_buffer_append(buffer, name, strlen(name)) != 0)
+        return -1;
+    return text_buffer_append(buffer, tail, SYMBOL_ROW_TAIL_LEN);
+}
+
+/* Formats the .obj contents from the image, listing the same entries as the .ent file. Returns 0 on success */
+static int format_binary_object_file(AssemblerContext *ctx)
+{
+    BinaryObjectSymbol *entries;
+    TableNode *node;
+    int entry_count = 0;
+
+    for (node = ctx->symbol_table->head; node; node = node->next)
+    {
+        if (((SymbolInfo *)node->data)->is_entry == 1)
+            entry_count++;
+    }
+
+    entries = arena_alloc(&ctx->arena, sizeof(BinaryObjectSymbol) * entry_count);
+    if (!entries)
+        return -1;
+
+    entry_count = 0;
+    for (node = ctx->symbol_table->head; node; node = node->next)
+    {
+        SymbolInfo *info = (SymbolInfo *)node->data;
+        if (info->is_entry == 1)
+        {
+            entries[entry_count].name = info->name;
+            entries[entry_count].address = info->address;
+            entry_count++;
+        }
+    }
+
+    return format_binary_object(&ctx->binary_object_file, &ctx->image, INITIAL_IC, entries, entry_count);
+}
+
+/*
+ * Formats the .ob, .ent and .ext contents into the context's text buffers,
+ * and the .obj contents when a binary object was asked for.
+ * Every .ob row has the same width, so the object file is sized from the
+ * word counts up front and the rows are written straight into it.
+ * Returns 0 on success, -1 if out of memory.
+ */
+int format_output_files(AssemblerContext *ctx)
+{
+    const MachineImage *image = &ctx->image;
+    Table *symbol_table = ctx->symbol_table;
+    TextBuffer *ob = &ctx->object_file;
+    TextBuffer *ent = &ctx->entries_file;
+    TextBuffer *ext = &ctx->externals_file;
+    int failed = 0;
+    char *rows;
+    int i;
+
+    if (text_buffer_reserve(ob, OBJECT_HEADER_LEN +
+                                    (size_t)(image->code_count + image->data_count) * OBJECT_ROW_LEN) != 0)
+        return -1;
+
+    /* fixed-width header, then the code image followed by the data image */
+    failed |= text_buffer_printf(ob, "%10d\t%10d\n", image->code_count, image->data_count);
+
+    rows = text_buffer_extend(ob, (size_t)(image->code_count + image->data_count) * OBJECT_ROW_LEN);
+    if (!rows)
+        return -1;
+    format_object_rows(rows, INITIAL_IC, image->code, image->code_count);
+    format_object_rows(rows + (size_t)image->code_count * OBJECT_ROW_LEN, INITIAL_IC + image->code_count,
+                       image->data, image->data_count);
+
+    /* .ext lists every word that refers to an extern, by address */
+    for (i = 0; i < image->fixup_count; i++)
+    {
+        if (image->fixups[i].is_extern)
+            failed |= append_symbol_row(ext, image->fixups[i].label, INITIAL_IC + image->fixups[i].address);
+    }
+
+    /* .ent lists every entry label */
+    {
+        TableNode *current_node = symbol_table->head;
+        while (current_node)
+        {
+            SymbolInfo *info = (SymbolInfo *)current_node->data;
+            if (info->is_entry == 1)
+                failed |= append_symbol_row(ent, info->name, info->address);
+            current_node = current_node->next;
+        }
+    }
+
+    /* the binary object comes from the same image, in the same pass */
+    if (ctx->options.write_binary_object)
+        failed |= format_binary_object_file(ctx);
+
+    return failed ? -1 : 0;
+}
+
+/*
+ * Writes the formatted outputs next to each other in the output directory.
+ * .ent and .ext are only created when they have content.
+ * Returns 0 on success, -1 if any file could not be written.
+ */
+int write_output_files(AssemblerContext *ctx)
+{
+    char path[PATH_MAX];
+    int failed = 0;
+
+    /* Every output is named after the input, so different inputs never clobber each other */
+    context_output_path(ctx, ".ob", path, sizeof(path));
+    if (text_buffer_write_file(&ctx->object_file, path) != 0)
+    {
+        fprintf(stderr, "Error opening %s\n", path);
+        failed = 1;
+    }
+
+    if (ctx->entries_file.size > 0)
+    {
+        context_output_path(ctx, ".ent", path, sizeof(path));
+        if (text_buffer_write_file(&ctx->entries_file, path) != 0)
+        {
+            fprintf(stderr, "Error opening %s\n", path);
+            failed = 1;
+        }
+    }
+
+    if (ctx->externals_file.size > 0)
+    {
+        context_output_path(ctx, ".ext", path, sizeof(path));
+        if (text_buffer_write_file(&ctx->externals_file, path) != 0)
+        {
+            fprintf(stderr, "Error opening %s\n", path);
+            failed = 1;
+        }
+    }
+
+    if (ctx->binary_object_file.size > 0)
+    {
+        context_output_path(ctx, ".obj", path, sizeof(path));
+        if (text_buffer_write_file(&ctx->binary_object_file, path) != 0)
+        {
+            fprintf(stderr, "Error opening %s\n", path);
+            failed = 1;
+        }
+    }
+
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,33 @@
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include "../common/errors/errors.h"
+#include "context.h"
+
+/* Part of every build cache key; bump whenever the generated files may change */
+#define ASSEMBLER_VERSION "1.1.0"
+
+/* Outcome of assembling a single source file */
+typedef enum
+{
+    ASSEMBLY_OK,
+    ASSEMBLY_FAILED_IO,            /* source could not be read or outputs could not be produced */
+    ASSEMBLY_FAILED_PRE_ASSEMBLER, /* errors in macro expansion */
+    ASSEMBLY_FAILED_FIRST_PASS,    /* errors while parsing and encoding */
+    ASSEMBLY_FAILED_SECOND_PASS    /* errors while resolving labels */
+} AssemblyResult;
+
+/* Runs every stage on one source file, using (and filling) the given empty context */
+AssemblyResult assemble_file(AssemblerContext *ctx, const char *input_filename);
+
+/* Runs every stage on ctx->source, leaving the outputs in memory only */
+AssemblyResult assemble_source(AssemblerContext *ctx);
+
+/* Prints the diagnostics of one file. Safe to call long after assemble_file returned */
+void report_assembly_result(const char *input_filename, AssemblyResult result, StatusInfo *status_info);
+
+void report_stage_errors(StatusInfo *status_info, const char *stage_name);
+int format_output_files(AssemblerContext *ctx);
+int write_output_files(AssemblerContext *ctx);
+
+#endif
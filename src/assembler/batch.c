@@ -0,0 +1,179 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "batch.h"
+#include "assembler.h"
+
+/*-----------------------------------------------------------
+    Batch assembly
+    Sequential loop, or a pthread worker pool for -j N
+------------------------------------------------------------*/
+
+/* A single input file and, once assembled, its result */
+typedef struct
+{
+    const char *input_filename;
+    StatusInfo *status_info; /* owned by the job until reported */
+    AssemblyResult result;
+    int is_done;
+} BatchJob;
+
+/* State shared by all workers of a pool */
+typedef struct
+{
+    BatchJob *jobs;
+    int job_count;
+    int next_job;            /* index of the next job to hand out */
+    const AssemblerOptions *options; /* shared by every worker's context */
+    pthread_mutex_t lock;    /* guards next_job and every is_done flag */
+    pthread_cond_t job_done; /* signaled whenever a job finishes */
+} BatchQueue;
+
+/* Assembles the files one after the other, reporting each right away */
+static int run_sequential(char *inputs[], int input_count, const AssemblerOptions *options)
+{
+    AssemblerContext *ctx = context_create(options);
+    AssemblyResult result;
+    int i;
+
+    if (!ctx)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < input_count; i++)
+    {
+        result = assemble_file(ctx, inputs[i]);
+        report_assembly_result(inputs[i], result, ctx->status_info);
+
+        /* Reset state for the next file */
+        context_reset(ctx);
+    }
+
+    context_destroy(ctx);
+    return 0;
+}
+
+static void *worker_main(void *arg)
+{
+    BatchQueue *queue = (BatchQueue *)arg;
+    AssemblerContext *ctx = context_create(queue->options);
+    BatchJob *job;
+
+    /* Diagnostics are kept in the job and printed by the reporting thread */
+    if (ctx)
+        ctx->status_info->echo = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&queue->lock);
+        if (queue->next_job >= queue->job_count)
+        {
+            pthread_mutex_unlock(&queue->lock);
+            break;
+        }
+        job = &queue->jobs[queue->next_job++];
+        pthread_mutex_unlock(&queue->lock);
+
+        if (ctx)
+        {
+            job->result = assemble_file(ctx, job->input_filename);
+            job->status_info = context_detach_status(ctx);
+            context_reset(ctx);
+        }
+
+        pthread_mutex_lock(&queue->lock);
+        job->is_done = 1;
+        pthread_cond_broadcast(&queue->job_done);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    context_destroy(ctx);
+    return NULL;
+}
+/* Assembles the files on worker_count threads, reporting them in input order */
+static int run_pool(char *inputs[], int input_count, int worker_count, const AssemblerOptions *options)
+{
+    BatchQueue queue;
+    pthread_t *workers;
+    int started = 0;
+    int i;
+
+    if (worker_count > input_count)
+        worker_count = input_count;
+
+    queue.jobs = malloc(sizeof(BatchJob) * input_count);
+    workers = malloc(sizeof(pthread_t) * worker_count);
+    if (!queue.jobs || !workers)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(queue.jobs);
+        free(workers);
+        return 1;
+    }
+
+    for (i = 0; i < input_count; i++)
+    {
+        queue.jobs[i].input_filename = inputs[i];
+        queue.jobs[i].status_info = NULL;
+        queue.jobs[i].result = ASSEMBLY_FAILED_IO;
+        queue.jobs[i].is_done = 0;
+    }
+    queue.job_count = input_count;
+    queue.next_job = 0;
+    queue.options = options;
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.job_done, NULL);
+
+    for (i = 0; i < worker_count; i++)
+    {
+        if (pthread_create(&workers[started], NULL, worker_main, &queue) != 0)
+        {
+            fprintf(stderr, "Failed to start worker thread %d\n", i);
+            continue;
+        }
+        started++;
+    }
+
+    /* No worker could be started: fall back to this thread */
+    if (started == 0)
+        worker_main(&queue);
+
+    /* Report each file as soon as it and every file before it are done */
+    for (i = 0; i < input_count; i++)
+    {
+        BatchJob *job = &queue.jobs[i];
+
+        pthread_mutex_lock(&queue.lock);
+        while (!job->is_done)
+            pthread_cond_wait(&queue.job_done, &queue.lock);
+        pthread_mutex_unlock(&queue.lock);
+
+        if (job->status_info)
+        {
+            report_assembly_result(job->input_filename, job->result, job->status_info);
+            free_status_info(job->status_info);
+        }
+        else
+        {
+            fprintf(stderr, "Memory allocation failed for %s\n", job->input_filename);
+        }
+    }
+
+    for (i = 0; i < started; i++)
+        pthread_join(workers[i], NULL);
+
+    pthread_cond_destroy(&queue.job_done);
+    pthread_mutex_destroy(&queue.lock);
+    free(workers);
+    free(queue.jobs);
+    return 0;
+}
+
+int run_batch(char *inputs[], int input_count, int worker_count, const AssemblerOptions *options)
+{
+    if (worker_count <= 1 || input_count <= 1)
+        return run_sequential(inputs, input_count, options);
+    return run_pool(inputs, input_count, worker_count, options);
+}
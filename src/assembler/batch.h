@@ -0,0 +1,15 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "context.h"
+
+/*
+ * Assembles input_count source files with the given options.
+ * With worker_count <= 1 the files are assembled one after the other on the calling thread.
+ * Otherwise they are spread over a pool of worker_count threads; diagnostics are still
+ * reported per file, in the order the files were given.
+ * Returns 0 on success, 1 if the batch could not be set up.
+ */
+int run_batch(char *inputs[], int input_count, int worker_count, const AssemblerOptions *options);
+
+#endif
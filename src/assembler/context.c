@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "context.h"
+
+void init_assembler_options(AssemblerOptions *options)
+{
+    options->output_dir = DEFAULT_OUTPUT_DIR;
+    options->write_expanded_file = 0;
+    options->write_binary_object = 0;
+    options->pipeline = 0;
+    options->cache_dir = NULL;
+}
+
+AssemblerContext *context_create(const AssemblerOptions *options)
+{
+    AssemblerContext *ctx = malloc(sizeof(AssemblerContext));
+    if (!ctx)
+        return NULL;
+
+    ctx->input_path = NULL;
+    ctx->base_name[0] = '\0';
+    ctx->source = NULL;
+    ctx->source_length = 0;
+    file_contents_init(&ctx->loaded_source);
+    line_index_init(&ctx->line_index);
+    if (options)
+        ctx->options = *options;
+    else
+        init_assembler_options(&ctx->options);
+
+    ctx->macro_table = malloc(sizeof(MacroTable));
+    if (ctx->macro_table && init_macro_table(ctx->macro_table) != 0)
+    {
+        free(ctx->macro_table);
+        ctx->macro_table = NULL;
+    }
+    arena_init(&ctx->arena);
+    ctx->labels = interner_create();
+    ctx->symbol_table = table_create_interned();
+    ctx->status_info = create_status_info();
+    ctx->ast_head = NULL;
+    reset_machine_image(&ctx->image);
+    line_buffer_init(&ctx->expanded_source);
+    ctx->line_ring = NULL;
+    text_buffer_init(&ctx->object_file);
+    text_buffer_init(&ctx->entries_file);
+    text_buffer_init(&ctx->externals_file);
+    text_buffer_init(&ctx->binary_object_file);
+    if (!ctx->macro_table || !ctx->labels || !ctx->symbol_table || !ctx->status_info)
+    {
+        context_destroy(ctx);
+        return NULL;
+    }
+    ctx->IC = INITIAL_IC;
+    ctx->DC = 0;
+
+    return ctx;
+}
+
+int context_set_input(AssemblerContext *ctx, const char *input_path)
+{
+    ctx->input_path = input_path;
+    return extract_basename_no_ext(input_path, ctx->base_name, sizeof(ctx->base_name));
+}
+
+int context_load_source(AssemblerContext *ctx)
+{
+    file_contents_release(&ctx->loaded_source);
+    if (file_contents_load(&ctx->loaded_source, ctx->input_path) != 0)
+    {
+        ctx->source = NULL;
+        ctx->source_length = 0;
+        return -1;
+    }
+    ctx->source = ctx->loaded_source.data;
+    ctx->source_length = ctx->loaded_source.length;
+    return 0;
+}
+
+void context_set_source(AssemblerContext *ctx, const char *text, size_t length)
+{
+    ctx->source = text;
+    ctx->source_length = length;
+}
+
+void context_reset(AssemblerContext *ctx)
+{
+    ctx->input_path = NULL;
+    ctx->base_name[0] = '\0';
+    file_contents_release(&ctx->loaded_source);
+    ctx->source = NULL;
+    ctx->source_length = 0;
+
+    line_index_reset(&ctx->line_index);
+    reset_macro_table(ctx->macro_table, NULL);
+    line_buffer_reset(&ctx->expanded_source);
+    table_clear(ctx->symbol_table, NULL);
+    ctx->ast_head = NULL;
+    reset_machine_image(&ctx->image);
+    reset_status_info(ctx->status_info);
+    interner_clear(ctx->labels); /* after everything that points into it */
+    arena_reset(&ctx->arena);
+    ctx->IC = INITIAL_IC;
+    ctx->DC = 0;
+    text_buffer_reset(&ctx->object_file);
+    text_buffer_reset(&ctx->entries_file);
+    text_buffer_reset(&ctx->externals_file);
+    text_buffer_reset(&ctx->binary_object_file);
+}
+
+StatusInfo *context_detach_status(AssemblerContext *ctx)
+{
+    StatusInfo *status_info = ctx->status_info;
+    StatusInfo *fresh = create_status_info();
+
+    if (!fresh)
+        return NULL; /* keep using the current log, caller gets nothing */
+
+    fresh->echo = status_info->echo;
+    ctx->status_info = fresh;
+    return status_info;
+}
+
+void context_output_path(const AssemblerContext *ctx, const char *extension, char *path, size_t max_len)
+{
+    snprintf(path, max_len, "%s/%s%s", ctx->options.output_dir, ctx->base_name, extension);
+}
+
+void context_destroy(AssemblerContext *ctx)
+{
+    if (!ctx)
+        return;
+
+    file_contents_release(&ctx->loaded_source);
+    line_index_free(&ctx->line_index);
+    if (ctx->macro_table)
+        free_macro_table(ctx->macro_table);
+    free(ctx->macro_table);
+    text_buffer_free(&ctx->object_file);
+    text_buffer_free(&ctx->entries_file);
+    text_buffer_free(&ctx->externals_file);
+    text_buffer_free(&ctx->binary_object_file);
+    line_buffer_free(&ctx->expanded_source);
+    table_destroy(ctx->symbol_table, NULL);
+    interner_destroy(ctx->labels);
+    arena_free(&ctx->arena);
+    if (ctx->status_info)
+        free_status_info(ctx->status_info);
+    free(ctx);
+}
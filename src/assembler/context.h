@@ -0,0 +1,92 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "../common/errors/errors.h"
+#include "../common/table/table.h"
+#include "../common/intern/interner.h"
+#include "../common/arena/arena.h"
+#include "../common/AST/ast.h"
+#include "../common/encoding/encoding.h"
+#include "../common/utils/file_utils.h"
+#include "../common/lines/line_buffer.h"
+#include "../common/lines/line_ring.h"
+#include "../common/lines/line_index.h"
+#include "../common/text/text_buffer.h"
+#include "../stg_00_preprocessor/macro_table.h"
+
+#define DEFAULT_OUTPUT_DIR "output"
+#define INITIAL_IC 100
+
+/* Settings shared by every file of a run */
+typedef struct AssemblerOptions
+{
+    const char *output_dir;   /* directory that receives the generated files */
+    int write_expanded_file;  /* also write the macro-expanded source to <name>.am */
+    int write_binary_object;  /* also write the image as a binary object to <name>.obj */
+    int pipeline;             /* run the pre-assembler on its own thread, feeding the first pass */
+    const char *cache_dir;    /* build cache directory, NULL when caching is off */
+} AssemblerOptions;
+
+/*
+ * Everything a single assembly needs, passed through every stage.
+ * Nothing here is shared between contexts, so separate contexts can assemble
+ * files concurrently (one context per thread) without any locking.
+ */
+typedef struct AssemblerContext
+{
+    /* current input */
+    const char *input_path;    /* source file, as given by the caller */
+    char base_name[PATH_MAX];  /* input file name without directories or extension */
+    const char *source;        /* text of the input, not necessarily '\0' terminated */
+    size_t source_length;
+    FileContents loaded_source; /* input_path mapped or read, when source came from the file */
+    LineIndex line_index;      /* where every line of source starts, and what it is */
+    AssemblerOptions options;
+
+    /* per-file state, reset between files */
+    MacroTable *macro_table;   /* macros defined by the pre-assembler */
+    LineBuffer expanded_source; /* pre-assembler output, read by the first pass */
+    LineRing *line_ring;       /* replaces expanded_source while the stages are pipelined */
+    Arena arena;               /* AST nodes, directive values and symbols; freed in one reset */
+    Interner *labels;          /* every label name of this file, stored once */
+    Table *symbol_table;       /* interned label -> SymbolInfo (in the arena) */
+    ASTNode *ast_head;         /* parsed statements, in source order (in the arena) */
+    MachineImage image;        /* code and data words, and the label fixups */
+    StatusInfo *status_info;   /* errors and warnings of the current file */
+    int IC;                    /* instruction counter */
+    int DC;                    /* data counter */
+
+    /* generated files, kept in memory until written (or handed to a library caller) */
+    TextBuffer object_file;    /* .ob */
+    TextBuffer entries_file;   /* .ent, empty when there are no entries */
+    TextBuffer externals_file; /* .ext, empty when no extern is referenced */
+    TextBuffer binary_object_file; /* .obj, empty unless options.write_binary_object */
+} AssemblerContext;
+
+/* Fills options with the defaults (DEFAULT_OUTPUT_DIR, no .am or .obj file, no pipelining, no cache) */
+void init_assembler_options(AssemblerOptions *options);
+
+/* Allocates an empty context using a copy of options (defaults when NULL) */
+AssemblerContext *context_create(const AssemblerOptions *options);
+
+/* Points the context at a new input file. Returns 0 on success */
+int context_set_input(AssemblerContext *ctx, const char *input_path);
+
+/* Reads the file named by input_path into memory. Returns 0 on success */
+int context_load_source(AssemblerContext *ctx);
+
+/* Uses text (length bytes, owned by the caller) as the source of the current input */
+void context_set_source(AssemblerContext *ctx, const char *text, size_t length);
+
+/* Forgets all per-file state, keeping the allocations for the next file */
+void context_reset(AssemblerContext *ctx);
+
+/* Hands the diagnostics of the current file to the caller and starts a fresh log */
+StatusInfo *context_detach_status(AssemblerContext *ctx);
+
+/* Builds "<output_dir>/<base_name><extension>" */
+void context_output_path(const AssemblerContext *ctx, const char *extension, char *path, size_t max_len);
+
+void context_destroy(AssemblerContext *ctx);
+
+#endif
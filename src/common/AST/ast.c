@@ -5,29 +5,50 @@
  *
  * Description:
  * This file implements the functionality of the Abstract Syntax Tree (AST) module.
- * It includes functions for creating, managing, and freeing AST nodes that represent
- * the assembly code after parsing.
+ * It includes functions for creating and managing AST nodes that represent
+ * the assembly code after parsing. Nodes live in the assembly's arena and are
+ * released all at once when the arena is reset.
  *
  ******************************************************************************/
 
 #include <stdio.h>  /* For error printing (fprintf) */
-#include <stdlib.h> /* For dynamic memory allocation (malloc, free) */
+#include <stdlib.h>
 #include <string.h>
 #include "ast.h"
 #include "../tokenizer/tokenizer.h"
 
+/**
+ * @brief Copies the optional label of a new node into the arena.
+ *
+ * @return 0 on success, -1 if the arena is out of memory.
+ */
+static int set_node_label(Arena *arena, ASTNode *node, const char *label)
+{
+    node->label = NULL;
+    if (label != NULL)
+    {
+        node->label = arena_strndup(arena, label, strlen(label));
+        if (node->label == NULL)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 /**
  * @brief Creates a new AST node for a machine instruction.
  *
+ * @param arena The assembly's arena; the node lives until it is reset.
  * @param line_num The original line number in the source file.
  * @param label The label associated with the line (or NULL if none).
  * @param instruction Structure containing all information about the instruction.
  * @return ASTNode* Pointer to the newly created node, or NULL if memory allocation fails.
  */
-ASTNode *create_instruction_node(int line_num, const char *label, InstructionInfo instruction)
+ASTNode *create_instruction_node(Arena *arena, int line_num, const char *label, InstructionInfo instruction)
 {
-    /* 1. Dynamically allocate memory for the new node */
-    ASTNode *node = (ASTNode *)malloc(sizeof(ASTNode));
+    /* 1. Allocate the new node from the arena */
+    ASTNode *node = (ASTNode *)arena_alloc(arena, sizeof(ASTNode));
     if (node == NULL)
     {
         /* Handle memory allocation error */
@@ -38,22 +59,9 @@ ASTNode *create_instruction_node(int line_num, const char *label, InstructionInf
     /* 2. Initialize common fields */
     node->line_number = line_num;
     node->next = NULL;
-
-    /* Safely duplicate the label string. my_strdup allocates new memory and copies the string. */
-    /* This is important to avoid dependency on the original string and prevent memory issues. */
-    if (label != NULL)
+    if (set_node_label(arena, node, label) != 0)
     {
-        node->label = (char *)malloc(strlen(label) + 1);
-        if (node->label == NULL)
-        {
-            /* Handle memory allocation error for the label */
-            free(node);
-            return NULL;
-        }
-    }
-    else
-    {
-        node->label = NULL;
+        return NULL;
     }
 
     /* 3. Init instruction-specific fields */
@@ -68,15 +76,16 @@ ASTNode *create_instruction_node(int line_num, const char *label, InstructionInf
 /**
  * @brief Creates a new AST node for an assembler directive.
  *
+ * @param arena The assembly's arena; the node lives until it is reset.
  * @param line_num The original line number in the source file.
  * @param label The label associated with the line (or NULL if none).
  * @param directive Structure containing all information about the directive.
  * @return ASTNode* Pointer to the newly created node, or NULL if memory allocation fails.
  */
-ASTNode *create_directive_node(int line_num, const char *label, DirectiveInfo *directive_info)
+ASTNode *create_directive_node(Arena *arena, int line_num, const char *label, DirectiveInfo *directive_info)
 {
-    /* 1. Dynamically allocate memory for the new node */
-    ASTNode *node = (ASTNode *)malloc(sizeof(ASTNode));
+    /* 1. Allocate the new node from the arena */
+    ASTNode *node = (ASTNode *)arena_alloc(arena, sizeof(ASTNode));
     if (node == NULL)
     {
         /* Handle memory allocation error */
@@ -87,18 +96,9 @@ ASTNode *create_directive_node(int line_num, const char *label, DirectiveInfo *d
     /* 2. Initialize common fields (same logic as previous function) */
     node->line_number = line_num;
     node->next = NULL;
-    if (label != NULL)
-    {
-        node->label = (char *)malloc(strlen(label) + 1);
-        if (node->label == NULL)
-        {
-            free(node);
-            return NULL;
-        }
-    }
-    else
+    if (set_node_label(arena, node, label) != 0)
     {
-        node->label = NULL;
+        return NULL;
     }
 
     /* 3. Initialize directive-specific fields */
@@ -126,90 +126,9 @@ void append_ast_node(ASTNode **head, ASTNode **tail, ASTNode *new_node)
     }
 }
 
-/**
- * @brief Frees all memory allocated for the AST (the linked list).
- *
- * @param head Pointer to the head of the linked list (the first node).
- */
-void free_ast(ASTNode *head)
-{
-    ASTNode *current = head;
-    ASTNode *next_node;
-
-    while (current != NULL)
-    {
-        /* save the next pointer before freeing the current node */
-        next_node = current->next;
-
-        /* 1. Free dynamically allocated memory inside the node */
-        if (current->label != NULL)
-        {
-            free(current->label);
-        }
-
-        if (current->type == INSTRUCTION_STATEMENT)
-        {
-            /*
-            free_instruction_contents(&(current->content.instruction));
-            */
-        }
-        else if (current->type == DIRECTIVE_STATEMENT)
-        {
-            /*
-            free_directive_contents(&(current->content.directive));
-            */
-        }
-
-        /* 2. Free the node itself */
-        free(current);
-        /* 3. Move to the next node */
-        current = next_node;
-    }
-}
-
-void free_operand(Operand *op)
-{
-    if (!op)
-        return;
-
-    if (op->mode == DIRECT && op->value.label != NULL)
-    {
-        free(op->value.label);
-    }
-    else if (op->mode == MAT_ACCESS && op->value.index.label != NULL)
-    {
-        free(op->value.index.label);
-    }
-}
-
-void free_instruction_contents(InstructionInfo *inst)
-{
-    free_operand(&inst->src_op);
-    free_operand(&inst->dest_op);
-}
-
-void free_directive_contents(DirectiveInfo *dir)
-{
-    switch (dir->type)
-    {
-    case DATA:
-        free(dir->params.data.values);
-        break;
-
-    case STRING:
-        free(dir->params.str);
-        break;
-
-    case ENTRY:
-    case EXTERN:
-    default:
-        break;
-    }
-}
-
-AddressingMode get_mode(Tokens tokenized_line, int token_idx)
+AddressingMode get_mode(const Tokens *tokenized_line, int token_idx)
 {
-    char *value = tokenized_line.tokens[token_idx];
+    char *value = token_text(tokenized_line, token_idx);
     if (strcmp(value, "") == 0)
         return NONE;
     if (is_valid_mat_access(value))
@@ -2,6 +2,7 @@
 #define AST_H
 #include "../tokenizer/tokenizer.h"
 #include "../errors/errors.h"
+#include "../arena/arena.h"
 /*===============================
   Type Definitions (Enums)
 ===============================*/
@@ -72,11 +73,11 @@ typedef struct Operand
     union
     {
         int immediate_value; /* for IMMEDIATE */
-        char *label;         /* for DIRECT */
+        const char *label;   /* for DIRECT, interned */
         int reg_num;         /* for DIRECT_REGISTER */
         struct               /* for MATRIX_ACCESS */
         {
-            char *label;     /* label of the matrix */
+            const char *label; /* label of the matrix, interned */
             int row_reg_num; /* register holding the index */
             int col_reg_num; /* register holding the index */
         } index;
@@ -141,9 +142,9 @@ typedef struct ASTNode
   Function Prototypes
 ===============================*/
 
-/* AST node builders*/
-ASTNode *create_instruction_node(int line_num, const char *label, InstructionInfo instruction);
-ASTNode *create_directive_node(int line_num, const char *label, DirectiveInfo *directive);
+/* AST node builders; nodes are allocated from the arena and never freed individually */
+ASTNode *create_instruction_node(Arena *arena, int line_num, const char *label, InstructionInfo instruction);
+ASTNode *create_directive_node(Arena *arena, int line_num, const char *label, DirectiveInfo *directive);
 /* Append an ASTNode to the end of the list, updating head and tail pointers */
 void append_ast_node(ASTNode **head, ASTNode **tail, ASTNode *new_node);
 
@@ -157,13 +158,7 @@ Operand *create_index_operand(const char *label, int reg_num);
 InstructionInfo *create_instruction_info();
 DirectiveInfo *create_directive_info();
 
-/* destroy structs */
-void free_ast(ASTNode *head);
-void free_operand(Operand *op);
-void free_instruction_contents(InstructionInfo *inst);
-void free_directive_contents(DirectiveInfo *dir);
-
-AddressingMode get_mode(Tokens tokenized_line, int token_idx);
+AddressingMode get_mode(const Tokens *tokenized_line, int token_idx);
 int expect_operands(Opcode opcode);
 const char *get_ad_mod_name(AddressingMode mode);
 
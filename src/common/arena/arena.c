@@ -0,0 +1,103 @@
+/*
+ * arena.c
+ *
+ * Per-assembly bump allocator. Blocks are chained; a request that does not
+ * fit the current block starts a new one, at least ARENA_BLOCK_SIZE bytes.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_BLOCK_SIZE 65536
+
+/* Strictest alignment any allocation may need */
+typedef union
+{
+    long l;
+    double d;
+    void *p;
+} ArenaAlign;
+
+#define ARENA_ALIGN sizeof(ArenaAlign)
+
+struct ArenaBlock
+{
+    ArenaBlock *next;
+    size_t used;
+    size_t capacity;
+    ArenaAlign data[1]; /* capacity bytes follow */
+};
+
+void arena_init(Arena *arena)
+{
+    arena->blocks = NULL;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+    ArenaBlock *block = arena->blocks;
+    void *memory;
+
+    size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    if (size == 0)
+        size = ARENA_ALIGN;
+
+    if (!block || block->capacity - block->used < size)
+    {
+        size_t capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = malloc(sizeof(ArenaBlock) + capacity);
+        if (!block)
+            return NULL;
+        block->used = 0;
+        block->capacity = capacity;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    memory = (char *)block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+char *arena_strndup(Arena *arena, const char *s, size_t len)
+{
+    char *copy = arena_alloc(arena, len + 1);
+
+    if (!copy)
+        return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+void arena_reset(Arena *arena)
+{
+    ArenaBlock *block = arena->blocks;
+
+    if (!block)
+        return;
+
+    /* free everything but the oldest block, which is usually enough for a whole file */
+    while (block->next)
+    {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    block->used = 0;
+    arena->blocks = block;
+}
+
+void arena_free(Arena *arena)
+{
+    ArenaBlock *block = arena->blocks;
+
+    while (block)
+    {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
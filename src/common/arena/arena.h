@@ -0,0 +1,31 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/*
+ * A bump-pointer allocator for data that lives exactly as long as one
+ * assembly (AST nodes, directive values, symbols). Nothing is freed
+ * individually; arena_reset releases everything at once.
+ */
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct
+{
+    ArenaBlock *blocks; /* newest block first; the oldest one is kept across resets */
+} Arena;
+
+void arena_init(Arena *arena);
+
+/* Returns size bytes aligned for any type, or NULL if out of memory */
+void *arena_alloc(Arena *arena, size_t size);
+
+/* Copies the len bytes at s plus a terminator. Returns NULL if out of memory */
+char *arena_strndup(Arena *arena, const char *s, size_t len);
+
+/* Releases every allocation, keeping the first block for the next file */
+void arena_reset(Arena *arena);
+
+void arena_free(Arena *arena);
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * build_cache.c
+ *
+ * Content-addressed cache of assembler outputs, see build_cache.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "build_cache.h"
+#include "../utils/file_utils.h"
+
+/* 32-bit FNV-1a, continued from hash */
+static unsigned long fnv1a(unsigned long hash, const char *data, size_t length)
+{
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+void cache_make_key(const char *text, size_t length, const char *version, char *key, size_t size)
+{
+    /* two independent 32-bit hashes plus the length keep collisions out of reach without long long */
+    unsigned long first = fnv1a(2166136261UL, version, strlen(version) + 1);
+    unsigned long second = fnv1a(0x811C9DC5UL ^ 0x5BD1E995UL, version, strlen(version) + 1);
+
+    first = fnv1a(first, text, length);
+    second = fnv1a(second, text, length);
+    snprintf(key, size, "%08lx%08lx-%lx", first, second, (unsigned long)length);
+}
+
+static void entry_path(const char *cache_dir, const char *key, const char *name, char *path, size_t size)
+{
+    if (name)
+        snprintf(path, size, "%s/%s/%s", cache_dir, key, name);
+    else
+        snprintf(path, size, "%s/%s", cache_dir, key);
+}
+
+int cache_has_entry(const char *cache_dir, const char *key)
+{
+    char path[PATH_MAX];
+    struct stat st;
+
+    entry_path(cache_dir, key, NULL, path, sizeof(path));
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+int cache_read_file(const char *cache_dir, const char *key, const char *name, TextBuffer *buffer)
+{
+    char path[PATH_MAX];
+    char *contents;
+    size_t length;
+    struct stat st;
+    int failed;
+
+    entry_path(cache_dir, key, name, path, sizeof(path));
+    if (stat(path, &st) != 0)
+        return 1;
+
+    contents = read_file_contents(path, &length);
+    if (!contents)
+        return -1;
+    failed = text_buffer_append(buffer, contents, length);
+    free(contents);
+    return failed ? -1 : 0;
+}
+
+int cache_fetch_file(const char *cache_dir, const char *key, const char *name, const char *destination)
+{
+    char path[PATH_MAX];
+    TextBuffer contents;
+    struct stat st;
+    int failed;
+
+    entry_path(cache_dir, key, name, path, sizeof(path));
+    if (stat(path, &st) != 0)
+        return 1;
+
+    /* never write through an old link into the cache */
+    remove(destination);
+    if (link(path, destination) == 0)
+        return 0;
+
+    /* different file system or no link support: copy */
+    text_buffer_init(&contents);
+    failed = cache_read_file(cache_dir, key, name, &contents) != 0 ||
+             text_buffer_write_file(&contents, destination) != 0;
+    text_buffer_free(&contents);
+    return failed ? -1 : 0;
+}
+
+int cache_store_entry(const char *cache_dir, const char *key, const char *names[], const TextBuffer *files[], int count)
+{
+    char temp_dir[PATH_MAX];
+    char path[PATH_MAX];
+    int i, failed = 0;
+
+    if (cache_has_entry(cache_dir, key))
+        return 0;
+
+    /* unique per process and per caller, so concurrent stores never collide */
+    snprintf(temp_dir, sizeof(temp_dir), "%s/%s.tmp.%ld.%lx", cache_dir, key,
+             (long)getpid(), (unsigned long)(size_t)files);
+    if (mkdir(temp_dir, 0700) != 0)
+        return -1;
+
+    for (i = 0; i < count && !failed; i++)
+    {
+        if (files[i]->size == 0)
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", temp_dir, names[i]);
+        failed = text_buffer_write_file(files[i], path) != 0;
+    }
+
+    entry_path(cache_dir, key, NULL, path, sizeof(path));
+    if (!failed && rename(temp_dir, path) == 0)
+        return 0;
+
+    /* failed, or another writer stored the same entry first */
+    for (i = 0; i < count; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", temp_dir, names[i]);
+        remove(path);
+    }
+    rmdir(temp_dir);
+    return cache_has_entry(cache_dir, key) ? 0 : -1;
+}
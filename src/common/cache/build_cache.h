@@ -0,0 +1,39 @@
+#ifndef BUILD_CACHE_H
+#define BUILD_CACHE_H
+
+#include <stddef.h>
+#include "../text/text_buffer.h"
+
+#define CACHE_KEY_LEN 40 /* room for a key, including '\0' */
+
+/*
+ * Content-addressed cache of generated files.
+ * Every entry is a directory <cache_dir>/<key> holding the files of one
+ * assembly under fixed names. The key is a hash of the source text and the
+ * assembler version, so a changed source or a new assembler never hits a
+ * stale entry. Entries are created under a temporary name and renamed into
+ * place, so concurrent writers and readers never see half-written entries.
+ */
+
+/* Builds the cache key of a source text (length bytes) for the given version */
+void cache_make_key(const char *text, size_t length, const char *version, char *key, size_t size);
+
+/* Returns 1 if the cache holds an entry for key */
+int cache_has_entry(const char *cache_dir, const char *key);
+
+/*
+ * Makes destination a copy of file name of the entry (a hard link when possible).
+ * Returns 0 on success, 1 if the entry has no such file, -1 on error.
+ */
+int cache_fetch_file(const char *cache_dir, const char *key, const char *name, const char *destination);
+
+/* Reads file name of the entry into buffer. Returns 0 on success, 1 if missing, -1 on error */
+int cache_read_file(const char *cache_dir, const char *key, const char *name, TextBuffer *buffer);
+
+/*
+ * Stores count files (names[i] with the contents of files[i]) as the entry for key.
+ * Empty buffers are skipped. Returns 0 on success (or if the entry already exists).
+ */
+int cache_store_entry(const char *cache_dir, const char *key, const char *names[], const TextBuffer *files[], int count);
+
+#endif
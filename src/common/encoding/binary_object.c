@@ -0,0 +1,134 @@
+/*
+ * binary_object.c
+ *
+ * Writes the assembled image in the binary object layout described in
+ * binary_object.h. The size of every section is known before anything is
+ * written, so the file is laid out in one block of the output buffer.
+ */
+
+#include <string.h>
+#include "binary_object.h"
+
+#define ALIGN4(n) (((n) + 3) & ~(size_t)3)
+
+static void put_u16(unsigned char *out, unsigned int value)
+{
+    out[0] = (unsigned char)(value & 0xFF);
+    out[1] = (unsigned char)((value >> 8) & 0xFF);
+}
+
+static void put_u32(unsigned char *out, unsigned long value)
+{
+    out[0] = (unsigned char)(value & 0xFF);
+    out[1] = (unsigned char)((value >> 8) & 0xFF);
+    out[2] = (unsigned char)((value >> 16) & 0xFF);
+    out[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+/* Index of the first extern fixup with the same label as fixup i (i itself if none) */
+static int first_extern_with_label(const MachineImage *image, int i)
+{
+    int j;
+    for (j = 0; j < i; j++)
+    {
+        if (image->fixups[j].is_extern && strcmp(image->fixups[j].label, image->fixups[i].label) == 0)
+            return j;
+    }
+    return i;
+}
+
+int format_binary_object(TextBuffer *out, const MachineImage *image, int first_address,
+                         const BinaryObjectSymbol *entries, int entry_count)
+{
+    size_t name_offsets[MEMORY_WORDS]; /* pool offset of each extern fixup's label */
+    size_t code_offset, data_offset, entries_offset, externs_offset, strings_offset;
+    size_t pool_size = 0, pool_used = 0, total;
+    int extern_count = 0;
+    unsigned char *base, *cursor;
+    int i;
+
+    /* size the string pool: entry names are unique, extern names are stored once */
+    for (i = 0; i < entry_count; i++)
+        pool_size += strlen(entries[i].name) + 1;
+    for (i = 0; i < image->fixup_count; i++)
+    {
+        if (!image->fixups[i].is_extern)
+            continue;
+        extern_count++;
+        if (first_extern_with_label(image, i) == i)
+            pool_size += strlen(image->fixups[i].label) + 1;
+    }
+
+    code_offset = BINARY_OBJECT_HEADER_SIZE;
+    data_offset = code_offset + 2 * (size_t)image->code_count;
+    entries_offset = ALIGN4(data_offset + 2 * (size_t)image->data_count);
+    externs_offset = entries_offset + 8 * (size_t)entry_count;
+    strings_offset = externs_offset + 8 * (size_t)extern_count;
+    total = strings_offset + pool_size;
+
+    base = (unsigned char *)text_buffer_extend(out, total);
+    if (!base)
+        return -1;
+    memset(base, 0, total);
+
+    memcpy(base, BINARY_OBJECT_MAGIC, 4);
+    put_u16(base + 4, BINARY_OBJECT_VERSION);
+    put_u16(base + 6, (unsigned int)first_address);
+    put_u32(base + 8, (unsigned long)image->code_count);
+    put_u32(base + 12, (unsigned long)image->data_count);
+    put_u32(base + 16, (unsigned long)entry_count);
+    put_u32(base + 20, (unsigned long)extern_count);
+    put_u32(base + 24, (unsigned long)code_offset);
+    put_u32(base + 28, (unsigned long)data_offset);
+    put_u32(base + 32, (unsigned long)entries_offset);
+    put_u32(base + 36, (unsigned long)externs_offset);
+    put_u32(base + 40, (unsigned long)strings_offset);
+    put_u32(base + 44, (unsigned long)pool_size);
+
+    cursor = base + code_offset;
+    for (i = 0; i < image->code_count; i++, cursor += 2)
+        put_u16(cursor, image->code[i] & WORD_MASK);
+    for (i = 0; i < image->data_count; i++, cursor += 2)
+        put_u16(cursor, image->data[i] & WORD_MASK);
+
+    cursor = base + entries_offset;
+    for (i = 0; i < entry_count; i++, cursor += 8)
+    {
+        size_t length = strlen(entries[i].name) + 1;
+
+        memcpy(base + strings_offset + pool_used, entries[i].name, length);
+        put_u32(cursor, (unsigned long)pool_used);
+        put_u32(cursor + 4, (unsigned long)entries[i].address);
+        pool_used += length;
+    }
+
+    cursor = base + externs_offset;
+    for (i = 0; i < image->fixup_count; i++)
+    {
+        const Fixup *fixup = &image->fixups[i];
+        int first;
+
+        if (!fixup->is_extern)
+            continue;
+
+        first = first_extern_with_label(image, i);
+        if (first == i)
+        {
+            size_t length = strlen(fixup->label) + 1;
+
+            memcpy(base + strings_offset + pool_used, fixup->label, length);
+            name_offsets[i] = pool_used;
+            pool_used += length;
+        }
+        else
+        {
+            name_offsets[i] = name_offsets[first];
+        }
+
+        put_u32(cursor, (unsigned long)name_offsets[i]);
+        put_u32(cursor + 4, (unsigned long)(first_address + fixup->address));
+        cursor += 8;
+    }
+
+    return 0;
+}
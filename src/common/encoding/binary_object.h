@@ -0,0 +1,55 @@
+#ifndef BINARY_OBJECT_H
+#define BINARY_OBJECT_H
+
+#include "encoding.h"
+#include "../text/text_buffer.h"
+
+/*
+ * Binary object file (.obj), an alternative to the base-4 .ob text for
+ * loaders that want the words as numbers. Every field is little-endian and
+ * every table starts at an offset recorded in the header, so the file can
+ * be mapped and read in place:
+ *
+ *   offset  size  field
+ *        0     4  magic "A4OB"
+ *        4     2  format version (BINARY_OBJECT_VERSION)
+ *        6     2  address of the first code word
+ *        8     4  code word count (IC)
+ *       12     4  data word count (DC)
+ *       16     4  entry count
+ *       20     4  extern reference count
+ *       24     4  offset of the code words
+ *       28     4  offset of the data words (they follow the code words)
+ *       32     4  offset of the entry table
+ *       36     4  offset of the extern table
+ *       40     4  offset of the string pool
+ *       44     4  size of the string pool
+ *
+ * Words are uint16 holding the 10-bit word (negative data in two's
+ * complement). The entry and extern tables hold {uint32 name, uint32
+ * address} pairs, where name is an offset into the string pool; externs are
+ * listed once per referring word, in address order. The pool holds each
+ * name once, '\0' terminated. Tables are 4-byte aligned; padding is zero.
+ */
+
+#define BINARY_OBJECT_MAGIC "A4OB"
+#define BINARY_OBJECT_VERSION 1
+#define BINARY_OBJECT_HEADER_SIZE 48
+
+/* A label and its address, as listed in the entry table */
+typedef struct
+{
+    const char *name;
+    int address;
+} BinaryObjectSymbol;
+
+/*
+ * Appends the binary object of image to out: its words, the entries given
+ * and the extern references recorded in its fixups (addresses relative to
+ * first_address, like the rest of the image).
+ * Returns 0 on success, -1 if out of memory.
+ */
+int format_binary_object(TextBuffer *out, const MachineImage *image, int first_address,
+                         const BinaryObjectSymbol *entries, int entry_count);
+
+#endif
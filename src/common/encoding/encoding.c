@@ -1,12 +1,14 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "encoding.h"
 #include "../AST/ast.h"
+#include "../log/log.h"
 
 /*
  * Note: The following data structures are assumed to be defined in included headers:
- * - BinCode (e.g., typedef char BinCode[10];)
+ * - MachineWord (typedef uint16_t MachineWord;)
  * - ASTNode and related structs (AddressingMode, Opcode, etc.)
  * - EncodedLine
  */
@@ -14,91 +16,89 @@
 /*
   typedef struct EncodedLine
   {
-      ASTNode *ast_node;
-      int decimal_address;
-      char base4_address[5];
-      BinCode words[5];
+      const ASTNode *ast_node;
+      MachineWord words[5];
+      const char *labels[5];
       int words_count;
-      struct EncodedLine *next;
   } EncodedLine;
 */
 
 /* ----------------LOW-LEVEL BIT & MEMORY UTILITIES---------------- */
 /**
- * Converts a logical bit number (0-9) to its inverse array index for a 10-char array.
- * Example: bit 9 maps to index 0, bit 0 maps to index 9.
+ * Writes an integer value into a specified range of bits of a machine word.
+ * Negative values are stored in two's complement.
  */
-int inverse_idx(int bit)
-{
-    if (bit > 9 || bit < 0)
-    {
-        /* handle error */
-        printf("INVALID BIT NUMBER\n");
-        return -1; /* Return error */
-    }
-    return 9 - bit;
-}
-
-/**
- * Writes an integer value into a specified range of bits in a binary code string.
- */
-void write_bits(BinCode bincode, int val, int start_bit, int end_bit)
+void write_bits(MachineWord *word, int val, int start_bit, int end_bit)
 {
     int num_bits = end_bit - start_bit + 1;
     int max_val = (1 << num_bits) - 1;
-    int i;
+    unsigned int field_mask;
 
     if (start_bit > end_bit)
     {
-        printf("INVALID: start bit: %d is larger than end bit: %d\n", start_bit, end_bit);
+        LOG_WARNING(LOG_ENCODING, ("INVALID: start bit: %d is larger than end bit: %d\n", start_bit, end_bit));
         return;
     }
 
     if (val > max_val)
     {
-        printf("INVALID VALUE: %d exceeds max allowed value %d for %d bits\n", val, max_val, num_bits);
+        LOG_WARNING(LOG_ENCODING, ("INVALID VALUE: %d exceeds max allowed value %d for %d bits\n", val, max_val, num_bits));
         return;
     }
 
-    for (i = 0; i < num_bits; i++)
-    {
-        /* Isolate the i-th bit of the value */
-        int bit_val = (val >> i) & 1;
-        /* Calculate the target bit position in the 0-9 range */
-        int target_bit = start_bit + i;
-        /* Write '0' or '1' to the correct inverse array index */
-        bincode[inverse_idx(target_bit)] = bit_val ? '1' : '0';
-    }
+    field_mask = ((unsigned int)max_val << start_bit) & WORD_MASK;
+    *word = (MachineWord)((*word & ~field_mask) | (((unsigned int)val << start_bit) & field_mask));
 }
 
 /**
- * Initializes the binary code words in an EncodedLine to all '0's.
+ * Returns the word as an unsigned 10-bit value.
  */
-void init_words(BinCode words[5], int count)
+int word_to_unsigned(MachineWord word)
 {
-    int i, j;
-    for (i = 0; i < count; i++)
-    {
-        for (j = 0; j < 10; j++)
-        {
-            words[i][j] = '0';
-        }
-    }
+    return word & WORD_MASK;
 }
 
 /**
- * Frees the memory allocated for a linked list of EncodedLine structs.
+ * Returns the word as a signed 10-bit (two's complement) value.
  */
-void free_encoded_line(EncodedLine *head)
+int word_to_signed(MachineWord word)
 {
-    EncodedLine *current = head;
-    EncodedLine *next;
+    int value = word & WORD_MASK;
+
+    if (value & 0x200)
+        value -= 0x400;
+    return value;
+}
 
-    while (current != NULL)
+/**
+ * Empties the image. Nothing is allocated, so there is nothing to free.
+ */
+void reset_machine_image(MachineImage *image)
+{
+    image->code_count = 0;
+    image->data_count = 0;
+    image->fixup_count = 0;
+}
+
+/**
+ * Copies an encoded instruction to the end of the code image and records a
+ * fixup for every word that waits for a label address.
+ */
+static void append_instruction_words(MachineImage *image, const EncodedLine *line)
+{
+    int i;
+
+    for (i = 0; i < line->words_count && image->code_count < MEMORY_WORDS; i++)
     {
-        next = current->next;
-        free(current);
-        current = next;
+        if (line->labels[i] != NULL)
+        {
+            Fixup *fixup = &image->fixups[image->fixup_count++];
+            fixup->label = line->labels[i];
+            fixup->line_number = line->ast_node->line_number;
+            fixup->address = (short)image->code_count;
+            fixup->is_extern = 0;
+        }
+        image->code[image->code_count++] = line->words[i];
     }
 }
 
@@ -106,36 +106,36 @@ void free_encoded_line(EncodedLine *head)
 /**
  * Assembles the A,R,E (Absolute, Relocatable, External) bits (0-1).
  */
-void assemble_AER(BinCode bincode, int AER)
+void assemble_AER(MachineWord *word, int AER)
 {
     /* AER values: 0 for Absolute, 1 for Relocatable, 2 for External */
-    write_bits(bincode, AER, 0, 1);
+    write_bits(word, AER, ARE_SHIFT, ARE_SHIFT + ARE_BITS - 1);
 }
 
 /**
  * Assembles the source operand addressing mode bits (2-3).
  */
-void assemble_src_op_mod(BinCode bincode, AddressingMode mode)
+void assemble_src_op_mod(MachineWord *word, AddressingMode mode)
 {
     /* Addressing modes are mapped to 0-3 */
-    write_bits(bincode, mode, 4, 5);
+    write_bits(word, mode, SRC_MODE_SHIFT, SRC_MODE_SHIFT + MODE_BITS - 1);
 }
 
 /**
  * Assembles the destination operand addressing mode bits (4-5).
  */
-void assemble_dest_op_mod(BinCode bincode, AddressingMode mode)
+void assemble_dest_op_mod(MachineWord *word, AddressingMode mode)
 {
     /* Addressing modes are mapped to 0-3 */
-    write_bits(bincode, mode, 2, 3);
+    write_bits(word, mode, DEST_MODE_SHIFT, DEST_MODE_SHIFT + MODE_BITS - 1);
 }
 
 /**
  * Assembles the opcode bits (6-9).
  */
-void assemble_opcode(BinCode bincode, Opcode opcode)
+void assemble_opcode(MachineWord *word, Opcode opcode)
 {
-    write_bits(bincode, opcode, 6, 9);
+    write_bits(word, opcode, OPCODE_SHIFT, OPCODE_SHIFT + OPCODE_BITS - 1);
 }
 
 /* ----------------OPERAND ENCODING IMPLEMENTATIONS---------------- */
@@ -152,49 +152,41 @@ void encode_operand(AddressingMode op_mode, int *added_word_idx, EncodedLine *li
         int val = is_src ? line->ast_node->content.instruction.src_op.value.immediate_value
                          : line->ast_node->content.instruction.dest_op.value.immediate_value;
 
-        write_bits(line->words[*added_word_idx], val, 2, 9);
-        assemble_AER(line->words[*added_word_idx], 0); /* Immediate is always Absolute */
+        write_bits(&line->words[*added_word_idx], val, OPERAND_SHIFT, OPERAND_SHIFT + OPERAND_BITS - 1);
+        assemble_AER(&line->words[*added_word_idx], 0); /* Immediate is always Absolute */
         line->words_count++;
         (*added_word_idx)++;
         break;
     }
     case DIRECT:
     {
-        char *label_name = is_src ? line->ast_node->content.instruction.src_op.value.label
+        const char *label_name = is_src ? line->ast_node->content.instruction.src_op.value.label
                                   : line->ast_node->content.instruction.dest_op.value.label;
 
-        printf("Waiting for address for label: %s\n", label_name);
+        LOG_TRACE(LOG_ENCODING, ("Waiting for address for label: %s\n", label_name));
         /* The address and AER bits will be filled in a later pass */
-        line->is_waiting_words[line->words_count] = 1;
+        line->labels[*added_word_idx] = label_name;
         line->words_count++;
         (*added_word_idx)++;
         break;
     }
     case MAT_ACCESS:
     {
-        int row_reg_num, col_reg_num;
-
-        if (is_src)
-        {
-            row_reg_num = line->ast_node->content.instruction.src_op.value.index.row_reg_num;
-            col_reg_num = line->ast_node->content.instruction.src_op.value.index.col_reg_num;
-        }
-        else
-        {
-            row_reg_num = line->ast_node->content.instruction.dest_op.value.index.row_reg_num;
-            col_reg_num = line->ast_node->content.instruction.dest_op.value.index.col_reg_num;
-        }
+        const Operand *op = is_src ? &line->ast_node->content.instruction.src_op
+                                   : &line->ast_node->content.instruction.dest_op;
+        int row_reg_num = op->value.index.row_reg_num;
+        int col_reg_num = op->value.index.col_reg_num;
 
         /* First extra word is for the matrix label address (handled like DIRECT) */
-        printf("Waiting for address for matrix label: %s\n", line->ast_node->content.instruction.src_op.value.label);
-        line->is_waiting_words[line->words_count] = 1;
+        LOG_TRACE(LOG_ENCODING, ("Waiting for address for matrix label: %s\n", op->value.index.label));
+        line->labels[*added_word_idx] = op->value.index.label;
         line->words_count++;
         (*added_word_idx)++;
 
         /* Second extra word encodes the two registers */
-        write_bits(line->words[*added_word_idx], row_reg_num, 6, 9); /* Source reg */
-        write_bits(line->words[*added_word_idx], col_reg_num, 2, 5); /* Dest reg */
-        assemble_AER(line->words[*added_word_idx], 0);               /* Register word is Absolute */
+        write_bits(&line->words[*added_word_idx], row_reg_num, SRC_REG_SHIFT, SRC_REG_SHIFT + REG_BITS - 1); /* Source reg */
+        write_bits(&line->words[*added_word_idx], col_reg_num, DEST_REG_SHIFT, DEST_REG_SHIFT + REG_BITS - 1); /* Dest reg */
+        assemble_AER(&line->words[*added_word_idx], 0);               /* Register word is Absolute */
         line->words_count++;
         (*added_word_idx)++;
         break;
@@ -209,11 +201,11 @@ void encode_operand(AddressingMode op_mode, int *added_word_idx, EncodedLine *li
         if (is_src)
         {
             reg_num = line->ast_node->content.instruction.src_op.value.reg_num;
-            write_bits(line->words[*added_word_idx], reg_num, 6, 9); /* Source bits */
+            write_bits(&line->words[*added_word_idx], reg_num, SRC_REG_SHIFT, SRC_REG_SHIFT + REG_BITS - 1); /* Source bits */
 
             if (!is_dest_mode_reg) /* If only source is a register */
             {
-                assemble_AER(line->words[*added_word_idx], 0);
+                assemble_AER(&line->words[*added_word_idx], 0);
                 line->words_count++;
                 (*added_word_idx)++;
             }
@@ -221,8 +213,8 @@ void encode_operand(AddressingMode op_mode, int *added_word_idx, EncodedLine *li
         else /* is_dest */
         {
             reg_num = line->ast_node->content.instruction.dest_op.value.reg_num;
-            write_bits(line->words[*added_word_idx], reg_num, 2, 5); /* Destination bits */
-            assemble_AER(line->words[*added_word_idx], 0);
+            write_bits(&line->words[*added_word_idx], reg_num, DEST_REG_SHIFT, DEST_REG_SHIFT + REG_BITS - 1); /* Destination bits */
+            assemble_AER(&line->words[*added_word_idx], 0);
             line->words_count++;
             /* No need to increment added_word_idx if src was also a register,
                as it has already been written to the same word. */
@@ -237,8 +229,7 @@ void encode_operand(AddressingMode op_mode, int *added_word_idx, EncodedLine *li
 /* Wrapper for operands that need a single extra word (Immediate, Direct) */
 void encode_single(AddressingMode mode, int *added_word_idx, EncodedLine *line, int is_src)
 {
-    /*TODO: print module + print stats */
-    printf("Encoding single operand at word index %d, mode: %s\n", *added_word_idx, get_ad_mod_name(mode));
+    LOG_TRACE(LOG_ENCODING, ("Encoding single operand at word index %d, mode: %s\n", *added_word_idx, get_ad_mod_name(mode)));
     encode_operand(mode, added_word_idx, line, is_src);
 }
 
@@ -262,44 +253,39 @@ EncodeFunc encoders[] = {
  */
 void encode_opcode(Opcode opcode, AddressingMode src_op_mode, AddressingMode dest_op_mode, EncodedLine *line)
 {
-    BinCode *bincode = &(line->words[0]);
+    MachineWord *word = &line->words[0];
 
-    printf("src_ad_mod: %s, dest_ad_mod: %s\n", get_ad_mod_name(src_op_mode), get_ad_mod_name(dest_op_mode));
+    LOG_TRACE(LOG_ENCODING, ("src_ad_mod: %s, dest_ad_mod: %s\n", get_ad_mod_name(src_op_mode), get_ad_mod_name(dest_op_mode)));
 
-    assemble_AER(*bincode, 0); /* Instruction word is always Absolute */
+    assemble_AER(word, 0); /* Instruction word is always Absolute */
     if (src_op_mode < 4)
-        assemble_src_op_mod(*bincode, src_op_mode);
+        assemble_src_op_mod(word, src_op_mode);
     if (dest_op_mode < 4)
-        assemble_dest_op_mod(*bincode, dest_op_mode);
-    assemble_opcode(*bincode, opcode);
+        assemble_dest_op_mod(word, dest_op_mode);
+    assemble_opcode(word, opcode);
 }
 
 /**
  * Main function to encode a full instruction line from the AST.
- * It orchestrates the encoding of the first word and any subsequent operand words.
+ * It orchestrates the encoding of the first word and any subsequent operand words,
+ * then appends them to the code image.
  */
-EncodedLine *encode_instruction_line(ASTNode *inst_node, int leader_idx)
+int encode_instruction_line(MachineImage *image, const ASTNode *inst_node)
 {
-    printf("----------- ENCODING LINE ----------- \n");
-
-    EncodedLine *encoded_line = malloc(sizeof(EncodedLine));
-    if (!encoded_line)
-        return NULL;
-
-    encoded_line->words_count = 1; /* Start with 1 for the opcode word */
-    encoded_line->ast_node = inst_node;
-    encoded_line->next = NULL;
-
+    EncodedLine encoded_line;
     Opcode opcode = inst_node->content.instruction.opcode;
     AddressingMode src_ad_mod = inst_node->content.instruction.src_op.mode;
     AddressingMode dest_ad_mod = inst_node->content.instruction.dest_op.mode;
-
     int added_word_idx = 1; /* Index for extra words, starts after opcode word */
 
-    init_words(encoded_line->words, 5);
+    LOG_TRACE(LOG_ENCODING, ("----------- ENCODING LINE ----------- \n"));
+
+    memset(&encoded_line, 0, sizeof(EncodedLine));
+    encoded_line.words_count = 1; /* Start with 1 for the opcode word */
+    encoded_line.ast_node = inst_node;
 
     /* 1. Encode the first word (opcode and modes) */
-    encode_opcode(opcode, src_ad_mod, dest_ad_mod, encoded_line);
+    encode_opcode(opcode, src_ad_mod, dest_ad_mod, &encoded_line);
 
     /* 2. Encode operand words */
     if (src_ad_mod == REGISTER && dest_ad_mod == REGISTER)
@@ -307,105 +293,66 @@ EncodedLine *encode_instruction_line(ASTNode *inst_node, int leader_idx)
         /* Special case: both operands are registers, share one word */
         int src_reg_num = inst_node->content.instruction.src_op.value.reg_num;
         int dest_reg_num = inst_node->content.instruction.dest_op.value.reg_num;
-        write_bits(encoded_line->words[added_word_idx], src_reg_num, 6, 9);
-        write_bits(encoded_line->words[added_word_idx], dest_reg_num, 2, 5);
-        assemble_AER(encoded_line->words[added_word_idx], 0);
-        encoded_line->words_count++;
+        write_bits(&encoded_line.words[added_word_idx], src_reg_num, SRC_REG_SHIFT, SRC_REG_SHIFT + REG_BITS - 1);
+        write_bits(&encoded_line.words[added_word_idx], dest_reg_num, DEST_REG_SHIFT, DEST_REG_SHIFT + REG_BITS - 1);
+        assemble_AER(&encoded_line.words[added_word_idx], 0);
+        encoded_line.words_count++;
     }
     else
     {
         /* Handle source and destination operands sequentially */
         if (src_ad_mod != NONE)
         {
-            encoders[src_ad_mod](src_ad_mod, &added_word_idx, encoded_line, 1); /* is_src = true */
+            encoders[src_ad_mod](src_ad_mod, &added_word_idx, &encoded_line, 1); /* is_src = true */
         }
         if (dest_ad_mod != NONE)
         {
-            encoders[dest_ad_mod](dest_ad_mod, &added_word_idx, encoded_line, 0); /* is_src = false */
+            encoders[dest_ad_mod](dest_ad_mod, &added_word_idx, &encoded_line, 0); /* is_src = false */
         }
     }
 
     /* For debugging: Print all generated words for the line */
-    printf("Encoded words:\n");
-    print_encoded_words(encoded_line);
-    return encoded_line;
+    if (LOG_TRACE_ENABLED(LOG_ENCODING))
+    {
+        log_printf("Encoded words:\n");
+        print_encoded_words(&encoded_line);
+    }
+
+    append_instruction_words(image, &encoded_line);
+    return encoded_line.words_count;
 }
 
-EncodedLine *encode_directive_line(ASTNode *directive_node, int leader_idx)
+/**
+ * Appends the words of a .data, .string or .mat directive to the data image.
+ * Other directives produce no words.
+ */
+int encode_directive_line(MachineImage *image, const ASTNode *directive_node)
 {
-    if (directive_node->content.directive.type == ENTRY || directive_node->content.directive.type == EXTERN)
-        return NULL;
+    DirectiveType type = directive_node->content.directive.type;
     int data_size;
-    data_size = directive_node->content.directive.params.data.size;
-    printf("----------- ENCODING LINE ----------- \n");
-
-    EncodedLine *encoded_line = malloc(sizeof(EncodedLine));
-    encoded_line->ast_node = directive_node;
-    encoded_line->next = NULL;
-
-    if (!encoded_line)
-        return NULL;
-
     int i;
-    switch (directive_node->content.directive.type)
-    {
-    case DATA:
-    {
 
-        encoded_line->words_count = data_size;
-        encoded_line->data_words = malloc(sizeof(BinCode) * data_size);
+    if (type != DATA && type != STRING && type != MAT)
+        return 0; /* .entry/.extern (and invalid directives) produce no words */
 
-        for (i = 0; i < encoded_line->words_count; i++)
-        {
-            int value = directive_node->content.directive.params.data.values[i];
-            printf("encoding integer %d\n", value);
-            BinCode data_word;
-            write_bits(encoded_line->data_words[i], value, 0, 9);
-            print_bincode(encoded_line->data_words[i]);
-        }
-        break;
-    }
-    break;
-    case STRING:
-    {
+    data_size = directive_node->content.directive.params.data.size;
+    LOG_TRACE(LOG_ENCODING, ("----------- ENCODING LINE ----------- \n"));
 
-        encoded_line->words_count = data_size;
-        encoded_line->data_words = malloc(sizeof(BinCode) * data_size);
-        printf("STR is: %s\n", directive_node->content.directive.params.str);
-        for (i = 0; i < data_size; i++)
-        {
-            int value = directive_node->content.directive.params.str[i];
-            printf("encoding integer %d\n", value);
-            BinCode data_word;
-            write_bits(encoded_line->data_words[i], value, 0, 9);
-            print_bincode(encoded_line->data_words[i]);
-        }
-        break;
-    }
-    break;
-    case MAT:
+    for (i = 0; i < data_size && image->data_count < MEMORY_WORDS; i++)
     {
-
-        encoded_line->words_count = data_size;
-        encoded_line->data_words = malloc(sizeof(BinCode) * data_size);
-
-        for (i = 0; i < data_size; i++)
-        {
-            int value = directive_node->content.directive.params.data.values[i];
-            printf("encoding integer %d\n", value);
-            BinCode data_word;
-            write_bits(encoded_line->data_words[i], value, 0, 9);
-            print_bincode(encoded_line->data_words[i]);
-        }
-        break;
-    }
-    break;
-    default:
-        return NULL;
+        /* .string words are its characters, .data/.mat words the parsed values */
+        int value = type == STRING ? directive_node->content.directive.params.str[i]
+                                   : directive_node->content.directive.params.data.values[i];
+        MachineWord *word = &image->data[image->data_count++];
+
+        LOG_TRACE(LOG_ENCODING, ("encoding integer %d\n", value));
+        *word = 0;
+        write_bits(word, value, 0, WORD_BITS - 1);
+        if (LOG_TRACE_ENABLED(LOG_ENCODING))
+            print_word(*word);
     }
 
-    return encoded_line;
-    /* switch */
+    return data_size;
 }
 
 /**
@@ -413,32 +360,27 @@ EncodedLine *encode_directive_line(ASTNode *directive_node, int leader_idx)
  */
 void print_encoded_words(const EncodedLine *line)
 {
-    int i, j;
+    int i;
     for (i = 0; i < line->words_count; i++)
     {
-        printf("Word %d: ", i);
-        if (line->is_waiting_words[i] != 1)
-        {
-            for (j = 0; j < 10; j++)
-            {
-                printf("%c", line->words[i][j]);
-            }
-        }
+        log_printf("Word %d: ", i);
+        if (line->labels[i] == NULL)
+            print_word(line->words[i]);
         else
-        {
-            printf("?");
-        }
-        printf("\n");
+            log_printf("?\n");
     }
 }
 
-void print_bincode(BinCode bincode)
+/**
+ * Prints a word as 10 binary digits, most significant bit first.
+ */
+void print_word(MachineWord word)
 {
-    int i;
+    int bit;
 
-    for (i = 0; i < 10; i++)
+    for (bit = WORD_BITS - 1; bit >= 0; bit--)
     {
-        printf("%c", bincode[i]);
+        log_printf("%c", ((word >> bit) & 1) ? '1' : '0');
     }
-    printf("\n");
+    log_printf("\n");
 }
\ No newline at end of file
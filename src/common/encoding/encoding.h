@@ -1,41 +1,87 @@
 #ifndef ENCODING_H
 #define ENCODING_H
+#include <stdint.h>
 #include "../AST/ast.h"
-typedef char BinCode[11];
 
+/* One 10-bit machine word, bit 0 is the least significant */
+typedef uint16_t MachineWord;
+
+#define WORD_BITS 10
+#define WORD_MASK 0x3FF
+
+/* Field positions (first bit and width) inside a machine word */
+#define ARE_SHIFT 0       /* A,R,E: 0 absolute, 1 external, 2 relocatable */
+#define ARE_BITS 2
+#define DEST_MODE_SHIFT 2 /* first word: destination addressing mode */
+#define SRC_MODE_SHIFT 4  /* first word: source addressing mode */
+#define MODE_BITS 2
+#define OPCODE_SHIFT 6
+#define OPCODE_BITS 4
+#define DEST_REG_SHIFT 2  /* register word: destination (or matrix column) register */
+#define SRC_REG_SHIFT 6   /* register word: source (or matrix row) register */
+#define REG_BITS 4
+#define OPERAND_SHIFT 2   /* immediate value or label address */
+#define OPERAND_BITS 8
+
+/* Words a program may occupy, code and data together */
+#define MEMORY_WORDS 256
+
+/* Longest instruction: opcode word plus two matrix operands */
+#define MAX_INSTRUCTION_WORDS 5
+
+/* Scratch record for the words of one instruction while it is being encoded */
 typedef struct EncodedLine
 {
-    ASTNode *ast_node;
-    int decimal_address;
-    char base4_address[5];
-    BinCode words[5];
-    BinCode *data_words;
-    int is_waiting_words[5];
+    const ASTNode *ast_node;
+    MachineWord words[MAX_INSTRUCTION_WORDS];
+    const char *labels[MAX_INSTRUCTION_WORDS]; /* label whose address goes in the word, or NULL */
     int words_count;
-    struct EncodedLine *next;
 } EncodedLine;
 
-typedef struct EncodedList
+/* A code word that needs a label address, patched by the second pass */
+typedef struct Fixup
+{
+    const char *label; /* interned operand label */
+    int line_number;   /* source line, for E503 */
+    short address;     /* index of the word in the code image */
+    short is_extern;   /* set once resolved to an external symbol */
+} Fixup;
+
+/*
+ * The assembled program: code and data images laid out as in memory, plus the
+ * words still waiting for a label. Sized for the whole machine, so encoding a
+ * file never allocates. Words past MEMORY_WORDS are dropped; the first pass
+ * reports E700 for such a file before any output is made.
+ */
+typedef struct MachineImage
 {
-    int size;                 /* number of lines in the list */
-    struct EncodedLine *head; /* pointer to the first line */
-    struct EncodedLine *tail; /* optional: makes appending faster */
-} EncodedList;
+    MachineWord code[MEMORY_WORDS]; /* word i is at address INITIAL_IC + i */
+    MachineWord data[MEMORY_WORDS]; /* word i is at address ICF + i */
+    Fixup fixups[MEMORY_WORDS];     /* in code address order */
+    int code_count;
+    int data_count;
+    int fixup_count;
+} MachineImage;
 
 /*------------- Encoding functions ------------- */
-EncodedLine *encode_instruction_line(ASTNode *inst_node, int leader_idx);
-EncodedLine *encode_directive_line(ASTNode *directive_node, int leader_idx);
+/* Both append the statement's words to the image and return how many words it takes */
+int encode_instruction_line(MachineImage *image, const ASTNode *inst_node);
+int encode_directive_line(MachineImage *image, const ASTNode *directive_node);
 void encode_opcode(Opcode opcode, AddressingMode src_op_mode, AddressingMode dest_op_mode, EncodedLine *line);
 
 /*------------- bit convertions functions ------------- */
-void write_bits(BinCode bincode, int val, int start_bit, int end_bit);
+/* Stores val into bits start_bit..end_bit of *word, leaving the other bits alone */
+void write_bits(MachineWord *word, int val, int start_bit, int end_bit);
+/* The word as an unsigned 10-bit value, and as a two's-complement value */
+int word_to_unsigned(MachineWord word);
+int word_to_signed(MachineWord word);
 
-/*------------- encoded list functions ------------- */
-void append_encoded_line(ASTNode **head, ASTNode **tail, EncodedLine *new_line);
-void free_encoded_line_list(EncodedLine *head);
+/*------------- machine image functions ------------- */
+/* Empties the image */
+void reset_machine_image(MachineImage *image);
 
 /* Define a function pointer type for encoding specific operand addressing modes */
 typedef void (*EncodeFunc)(AddressingMode mode, int *word_idx, EncodedLine *line, int is_src);
 void print_encoded_words(const EncodedLine *line);
-void print_bincode(BinCode bincode);
+void print_word(MachineWord word);
 #endif
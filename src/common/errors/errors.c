@@ -1,6 +1,7 @@
 #include "errors.h"
 #include "../printer/printer.h"
 #include <stdio.h>
+#include <stdlib.h>
 #define UNINIT_LINE_NUM -1
 
 /* Error info table */
@@ -81,21 +82,22 @@ void print_errors(StatusInfo *status_info)
     }
 }
 
-ErrorInfo write_error_log(StatusInfo *status_info, ErrorCode code, int line_number)
+int write_error_log(StatusInfo *status_info, ErrorCode code, int line_number)
 {
     /* dynamicaly increase error log memory space when needed */
-    if (status_info->error_count >= status_info->capacity)
+    if (status_info->error_count + status_info->warning_count >= status_info->capacity)
     {
-        status_info->capacity = (status_info->capacity == 0) ? 4 : status_info->capacity * 2;
-        int new_size = sizeof(ErrorInfo) * status_info->capacity;
-        ErrorInfo *new_log = realloc(status_info->error_log, new_size);
+        int capacity = (status_info->capacity == 0) ? 4 : status_info->capacity * 2;
+        ErrorInfo *new_log = realloc(status_info->error_log, sizeof(ErrorInfo) * capacity);
 
+        /* the assembler may run inside a library caller's process, so report instead of exiting */
         if (!new_log)
         {
-            printf("Memory allocation failed while expanding error log\n");
-            exit(1);
+            status_info->is_out_of_memory = 1;
+            return -1;
         }
         status_info->error_log = new_log;
+        status_info->capacity = capacity;
     }
 
     const ErrorInfo new_err = {
@@ -107,15 +109,58 @@ ErrorInfo write_error_log(StatusInfo *status_info, ErrorCode code, int line_numb
     status_info->error_log[status_info->error_count + status_info->warning_count] = new_err;
     if (new_err.sevirity == SEV_WARNING)
     {
-        PRINT_WRN(new_err);
+        if (status_info->echo && log_is_enabled(LOG_LEVEL_INFO, LOG_GENERAL))
+            PRINT_WRN(new_err);
         status_info->warning_count++;
     }
     else
     {
-        PRINT_ERR(new_err);
+        if (status_info->echo && log_is_enabled(LOG_LEVEL_INFO, LOG_GENERAL))
+            PRINT_ERR(new_err);
         status_info->error_count++;
     }
-    return new_err;
+    return 0;
+}
+
+void append_status_info(StatusInfo *dest, const StatusInfo *src)
+{
+    int i, echo = dest->echo;
+
+    /* the entries were already shown (if at all) when src logged them */
+    dest->echo = 0;
+    for (i = 0; i < src->error_count + src->warning_count; i++)
+        write_error_log(dest, src->error_log[i].code, src->error_log[i].line_number);
+    dest->echo = echo;
+    if (src->is_out_of_memory)
+        dest->is_out_of_memory = 1;
+}
+
+StatusInfo *create_status_info(void)
+{
+    StatusInfo *status_info = malloc(sizeof(StatusInfo));
+    if (!status_info)
+        return NULL;
+
+    status_info->capacity = 10;
+    status_info->error_log = malloc(sizeof(ErrorInfo) * status_info->capacity);
+    if (!status_info->error_log)
+    {
+        free(status_info);
+        return NULL;
+    }
+    status_info->error_count = 0;
+    status_info->warning_count = 0;
+    status_info->echo = 1;
+    status_info->is_out_of_memory = 0;
+    return status_info;
+}
+
+void reset_status_info(StatusInfo *status_info)
+{
+    /* keep the log buffer and its capacity, only forget the entries */
+    status_info->error_count = 0;
+    status_info->warning_count = 0;
+    status_info->is_out_of_memory = 0;
 }
 
 void free_status_info(StatusInfo *status_info)
@@ -67,12 +67,27 @@ typedef struct
     int error_count;      /* כמה שגיאות קיימות כרגע */
     int warning_count;
     int capacity;         /* כמה מוקצה כרגע בזיכרון */
+    int echo;             /* print each entry as soon as it is logged (at -v and above) */
+    int is_out_of_memory; /* an allocation failed; the log or the output may be incomplete */
 } StatusInfo;
 
 /* Returns pointer to ErrorInfo for given error code */
 ErrorInfo *get_error_log(ErrorCode code);
 
-ErrorInfo write_error_log(StatusInfo *status_info, ErrorCode code, int line_number);
+/*
+ * Logs code at line_number. Returns 0 on success, or -1 if the log could
+ * not grow; the entry is then dropped and is_out_of_memory is set.
+ */
+int write_error_log(StatusInfo *status_info, ErrorCode code, int line_number);
+
+/* Appends every entry of src to dest, in order, along with its out of memory flag */
+void append_status_info(StatusInfo *dest, const StatusInfo *src);
+
+/* Allocates an empty status info with a small initial error log */
+StatusInfo *create_status_info(void);
+
+/* Clears all logged errors and warnings and the out of memory flag, keeping the allocated log for reuse */
+void reset_status_info(StatusInfo *status_info);
 
 void free_status_info(StatusInfo *status_info);
 
@@ -0,0 +1,143 @@
+/*
+ * interner.c
+ *
+ * String pool for labels. Strings are packed into an arena (one malloc per
+ * block, not per name) and found through a hash index with linear probing.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "interner.h"
+
+#define INTERN_INITIAL_SLOTS 128
+
+/* FNV-1a over len bytes */
+static unsigned long hash_span(const char *s, size_t len)
+{
+    unsigned long hash = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)s[i];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+/* Index of the slot holding the span, or of the free slot where it belongs */
+static size_t find_slot(const Interner *interner, const char *s, size_t len, unsigned long hash)
+{
+    size_t mask = interner->slot_count - 1;
+    size_t i = (size_t)hash & mask;
+
+    while (interner->slots[i] != NULL)
+    {
+        if (interner->hashes[i] == hash &&
+            strncmp(interner->slots[i], s, len) == 0 && interner->slots[i][len] == '\0')
+            break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* Doubles the index. Returns 0 on success, -1 if out of memory */
+static int grow(Interner *interner)
+{
+    size_t new_count = interner->slot_count * 2;
+    const char **new_slots = calloc(new_count, sizeof(*new_slots));
+    unsigned long *new_hashes = malloc(new_count * sizeof(*new_hashes));
+    size_t i, j;
+
+    if (!new_slots || !new_hashes)
+    {
+        free(new_slots);
+        free(new_hashes);
+        return -1;
+    }
+
+    for (i = 0; i < interner->slot_count; i++)
+    {
+        if (interner->slots[i] == NULL)
+            continue;
+        j = (size_t)interner->hashes[i] & (new_count - 1);
+        while (new_slots[j] != NULL)
+            j = (j + 1) & (new_count - 1);
+        new_slots[j] = interner->slots[i];
+        new_hashes[j] = interner->hashes[i];
+    }
+
+    free(interner->slots);
+    free(interner->hashes);
+    interner->slots = new_slots;
+    interner->hashes = new_hashes;
+    interner->slot_count = new_count;
+    return 0;
+}
+
+Interner *interner_create(void)
+{
+    Interner *interner = malloc(sizeof(Interner));
+    if (!interner)
+        return NULL;
+
+    interner->slot_count = INTERN_INITIAL_SLOTS;
+    interner->slots = calloc(interner->slot_count, sizeof(*interner->slots));
+    interner->hashes = malloc(interner->slot_count * sizeof(*interner->hashes));
+    interner->count = 0;
+    arena_init(&interner->strings);
+    if (!interner->slots || !interner->hashes)
+    {
+        interner_destroy(interner);
+        return NULL;
+    }
+    return interner;
+}
+
+const char *intern_span(Interner *interner, const char *s, size_t len)
+{
+    unsigned long hash = hash_span(s, len);
+    size_t i = find_slot(interner, s, len, hash);
+    char *copy;
+
+    if (interner->slots[i] != NULL)
+        return interner->slots[i];
+
+    /* keep the index at most 70% full */
+    if ((interner->count + 1) * 10 > interner->slot_count * 7)
+    {
+        if (grow(interner) != 0)
+            return NULL;
+        i = find_slot(interner, s, len, hash);
+    }
+
+    copy = arena_strndup(&interner->strings, s, len);
+    if (!copy)
+        return NULL;
+    interner->slots[i] = copy;
+    interner->hashes[i] = hash;
+    interner->count++;
+    return copy;
+}
+
+const char *intern_string(Interner *interner, const char *s)
+{
+    return intern_span(interner, s, strlen(s));
+}
+
+void interner_clear(Interner *interner)
+{
+    arena_reset(&interner->strings);
+    interner->count = 0;
+    memset(interner->slots, 0, interner->slot_count * sizeof(*interner->slots));
+}
+
+void interner_destroy(Interner *interner)
+{
+    if (!interner)
+        return;
+    arena_free(&interner->strings);
+    free(interner->slots);
+    free(interner->hashes);
+    free(interner);
+}
@@ -0,0 +1,35 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <stddef.h>
+#include "../arena/arena.h"
+
+/*
+ * A per-assembly string pool. Every distinct string is stored once and the
+ * same pointer is handed back for equal strings, so two interned labels are
+ * equal exactly when their pointers are.
+ */
+typedef struct
+{
+    const char **slots;     /* open-addressing index, NULL marks a free slot */
+    unsigned long *hashes;  /* hash of the string in the matching slot */
+    size_t slot_count;      /* always a power of two */
+    size_t count;           /* distinct strings interned */
+    Arena strings;          /* string storage */
+} Interner;
+
+/* Returns NULL if out of memory */
+Interner *interner_create(void);
+
+/* Returns the pooled copy of s, or NULL if out of memory */
+const char *intern_string(Interner *interner, const char *s);
+
+/* Same for the len bytes at s, which need not be '\0' terminated */
+const char *intern_span(Interner *interner, const char *s, size_t len);
+
+/* Forgets every string; pointers handed out before become invalid */
+void interner_clear(Interner *interner);
+
+void interner_destroy(Interner *interner);
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * keywords.c
+ *
+ * Every reserved word of the language in one perfect-hash table, shared by
+ * the pre-assembler and the first pass.
+ *
+ * KEYWORD_HASH maps each keyword to its own slot. The multipliers were found
+ * by a brute-force search over the keyword list; when adding a keyword, pick
+ * new ones so that no two keywords share a slot, then re-place the entries.
+ */
+
+#include <string.h>
+#include "keywords.h"
+#include "../AST/ast.h"
+
+#define KEYWORD_SLOTS 64
+
+/* s must hold at least two characters */
+#define KEYWORD_HASH(s, len)                                                     \
+    (((unsigned char)(s)[0] * 24u + (unsigned char)(s)[1] * 27u +                \
+      (unsigned char)(s)[(len) - 1] * 10u + (unsigned)(len) * 4u) &              \
+     (KEYWORD_SLOTS - 1))
+
+#define NO_KEYWORD {NULL, 0, KEYWORD_RESERVED, 0}
+
+static const Keyword keyword_slots[KEYWORD_SLOTS] = {
+    NO_KEYWORD,                                 /*  0 */
+    NO_KEYWORD,                                 /*  1 */
+    NO_KEYWORD,                                 /*  2 */
+    NO_KEYWORD,                                 /*  3 */
+    {"extern", 6, KEYWORD_RESERVED, 0},         /*  4 */
+    NO_KEYWORD,                                 /*  5 */
+    {"r6", 2, KEYWORD_REGISTER, 6},             /*  6 */
+    {"mat", 3, KEYWORD_RESERVED, 0},            /*  7 */
+    {"bne", 3, KEYWORD_OPCODE, 10},             /*  8 */
+    {".entry", 6, KEYWORD_DIRECTIVE, ENTRY},    /*  9 */
+    NO_KEYWORD,                                 /* 10 */
+    {"red", 3, KEYWORD_OPCODE, 11},             /* 11 */
+    NO_KEYWORD,                                 /* 12 */
+    {"r1", 2, KEYWORD_REGISTER, 1},             /* 13 */
+    NO_KEYWORD,                                 /* 14 */
+    {"mcro", 4, KEYWORD_MACRO_START, 0},        /* 15 */
+    NO_KEYWORD,                                 /* 16 */
+    {"jsr", 3, KEYWORD_OPCODE, 13},             /* 17 */
+    NO_KEYWORD,                                 /* 18 */
+    {".string", 7, KEYWORD_DIRECTIVE, STRING},  /* 19 */
+    NO_KEYWORD,                                 /* 20 */
+    {"mov", 3, KEYWORD_OPCODE, 0},              /* 21 */
+    NO_KEYWORD,                                 /* 22 */
+    {"r3", 2, KEYWORD_REGISTER, 3},             /* 23 */
+    {"add", 3, KEYWORD_OPCODE, 2},              /* 24 */
+    {"not", 3, KEYWORD_OPCODE, 6},              /* 25 */
+    NO_KEYWORD,                                 /* 26 */
+    {"jmp", 3, KEYWORD_OPCODE, 9},              /* 27 */
+    {"inc", 3, KEYWORD_OPCODE, 7},              /* 28 */
+    {"lea", 3, KEYWORD_OPCODE, 4},              /* 29 */
+    {"prn", 3, KEYWORD_OPCODE, 12},             /* 30 */
+    {".extern", 7, KEYWORD_DIRECTIVE, EXTERN},  /* 31 */
+    {"entry", 5, KEYWORD_RESERVED, 0},          /* 32 */
+    {"r5", 2, KEYWORD_REGISTER, 5},             /* 33 */
+    {"string", 6, KEYWORD_RESERVED, 0},         /* 34 */
+    NO_KEYWORD,                                 /* 35 */
+    NO_KEYWORD,                                 /* 36 */
+    NO_KEYWORD,                                 /* 37 */
+    NO_KEYWORD,                                 /* 38 */
+    {".mat", 4, KEYWORD_DIRECTIVE, MAT},        /* 39 */
+    {"r0", 2, KEYWORD_REGISTER, 0},             /* 40 */
+    NO_KEYWORD,                                 /* 41 */
+    NO_KEYWORD,                                 /* 42 */
+    {"r7", 2, KEYWORD_REGISTER, 7},             /* 43 */
+    {"clr", 3, KEYWORD_OPCODE, 5},              /* 44 */
+    {"mcroend", 7, KEYWORD_MACRO_END, 0},       /* 45 */
+    NO_KEYWORD,                                 /* 46 */
+    NO_KEYWORD,                                 /* 47 */
+    NO_KEYWORD,                                 /* 48 */
+    {"dec", 3, KEYWORD_OPCODE, 8},              /* 49 */
+    {"r2", 2, KEYWORD_REGISTER, 2},             /* 50 */
+    {"cmp", 3, KEYWORD_OPCODE, 1},              /* 51 */
+    {"stop", 4, KEYWORD_OPCODE, 15},            /* 52 */
+    {"data", 4, KEYWORD_RESERVED, 0},           /* 53 */
+    {"rts", 3, KEYWORD_OPCODE, 14},             /* 54 */
+    NO_KEYWORD,                                 /* 55 */
+    NO_KEYWORD,                                 /* 56 */
+    NO_KEYWORD,                                 /* 57 */
+    {".data", 5, KEYWORD_DIRECTIVE, DATA},      /* 58 */
+    NO_KEYWORD,                                 /* 59 */
+    {"r4", 2, KEYWORD_REGISTER, 4},             /* 60 */
+    NO_KEYWORD,                                 /* 61 */
+    NO_KEYWORD,                                 /* 62 */
+    {"sub", 3, KEYWORD_OPCODE, 3},              /* 63 */
+};
+
+const Keyword *keyword_lookup_span(const char *s, size_t len)
+{
+    const Keyword *keyword;
+
+    if (len < 2 || len > KEYWORD_MAX_LEN)
+        return NULL;
+
+    keyword = &keyword_slots[KEYWORD_HASH(s, len)];
+    if (keyword->length != len || memcmp(keyword->name, s, len) != 0)
+        return NULL;
+    return keyword;
+}
+
+const Keyword *keyword_lookup(const char *token)
+{
+    size_t len = 0;
+
+    /* no keyword is longer than KEYWORD_MAX_LEN, so never scan further */
+    while (len <= KEYWORD_MAX_LEN && token[len] != '\0')
+        len++;
+    return keyword_lookup_span(token, len);
+}
@@ -0,0 +1,37 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include <stddef.h>
+
+/* What a reserved word means to the assembler */
+typedef enum
+{
+    KEYWORD_OPCODE,      /* value is the Opcode */
+    KEYWORD_DIRECTIVE,   /* value is the DirectiveType */
+    KEYWORD_REGISTER,    /* value is the register number */
+    KEYWORD_MACRO_START, /* mcro */
+    KEYWORD_MACRO_END,   /* mcroend */
+    KEYWORD_RESERVED     /* directive name without the dot; only reserved as a label */
+} KeywordKind;
+
+typedef struct
+{
+    const char *name;
+    size_t length;
+    KeywordKind kind;
+    int value;
+} Keyword;
+
+/* Longest keyword, ".string"/".extern"/"mcroend" */
+#define KEYWORD_MAX_LEN 7
+
+/*
+ * Classifies a token with one perfect-hash probe and a single comparison.
+ * Returns NULL when the token is not a keyword.
+ */
+const Keyword *keyword_lookup(const char *token);
+
+/* Same for the len bytes at s, which need not be '\0' terminated */
+const Keyword *keyword_lookup_span(const char *s, size_t len);
+
+#endif
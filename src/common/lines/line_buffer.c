@@ -0,0 +1,109 @@
+/*
+ * line_buffer.c
+ *
+ * In-memory list of lines, used to hand the pre-assembler's expanded source
+ * to the first pass without a round-trip through the .am file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "line_buffer.h"
+
+#define INITIAL_TEXT_CAPACITY 4096
+#define INITIAL_LINE_CAPACITY 128
+
+void line_buffer_init(LineBuffer *buffer)
+{
+    buffer->text = NULL;
+    buffer->text_size = 0;
+    buffer->text_capacity = 0;
+    buffer->lines = NULL;
+    buffer->line_count = 0;
+    buffer->line_capacity = 0;
+}
+
+int line_buffer_append(LineBuffer *buffer, const char *line, int source_line)
+{
+    LineInfo info;
+
+    info.source_line = source_line;
+    info.kind = LINE_CODE;
+    info.tokens = NULL;
+    return line_buffer_append_span(buffer, line, strlen(line), &info);
+}
+
+int line_buffer_append_span(LineBuffer *buffer, const char *line, size_t len, const LineInfo *info)
+{
+    /* grow the text block (line + '\0') */
+    if (buffer->text_size + len + 1 > buffer->text_capacity)
+    {
+        size_t new_capacity = buffer->text_capacity ? buffer->text_capacity : INITIAL_TEXT_CAPACITY;
+        char *new_text;
+
+        while (buffer->text_size + len + 1 > new_capacity)
+            new_capacity *= 2;
+        new_text = realloc(buffer->text, new_capacity);
+        if (!new_text)
+            return -1;
+        buffer->text = new_text;
+        buffer->text_capacity = new_capacity;
+    }
+
+    /* grow the line index */
+    if (buffer->line_count >= buffer->line_capacity)
+    {
+        int new_capacity = buffer->line_capacity ? buffer->line_capacity * 2 : INITIAL_LINE_CAPACITY;
+        BufferedLine *new_lines = realloc(buffer->lines, sizeof(BufferedLine) * new_capacity);
+        if (!new_lines)
+            return -1;
+        buffer->lines = new_lines;
+        buffer->line_capacity = new_capacity;
+    }
+
+    memcpy(buffer->text + buffer->text_size, line, len);
+    buffer->text[buffer->text_size + len] = '\0';
+    buffer->lines[buffer->line_count].offset = buffer->text_size;
+    buffer->lines[buffer->line_count].info = *info;
+    buffer->line_count++;
+    buffer->text_size += len + 1;
+    return 0;
+}
+
+const char *line_buffer_line(const LineBuffer *buffer, int idx)
+{
+    return buffer->text + buffer->lines[idx].offset;
+}
+
+int line_buffer_source_line(const LineBuffer *buffer, int idx)
+{
+    return buffer->lines[idx].info.source_line;
+}
+
+const LineInfo *line_buffer_info(const LineBuffer *buffer, int idx)
+{
+    return &buffer->lines[idx].info;
+}
+
+int line_buffer_write(const LineBuffer *buffer, FILE *file)
+{
+    int i;
+    for (i = 0; i < buffer->line_count; i++)
+    {
+        if (fputs(line_buffer_line(buffer, i), file) == EOF)
+            return -1;
+    }
+    return 0;
+}
+
+void line_buffer_reset(LineBuffer *buffer)
+{
+    buffer->text_size = 0;
+    buffer->line_count = 0;
+}
+
+void line_buffer_free(LineBuffer *buffer)
+{
+    free(buffer->text);
+    free(buffer->lines);
+    line_buffer_init(buffer);
+}
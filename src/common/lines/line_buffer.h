@@ -0,0 +1,59 @@
+#ifndef LINE_BUFFER_H
+#define LINE_BUFFER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "line_index.h"
+
+/* One line stored in a LineBuffer */
+typedef struct
+{
+    size_t offset; /* start of the line inside LineBuffer.text */
+    LineInfo info;
+} BufferedLine;
+
+/*
+ * A growable list of text lines kept in a single memory block.
+ * Every line is stored with its trailing newline (if it had one) and a
+ * terminating '\0', so it can be handed to string functions directly.
+ * Lines are addressed by index; offsets stay valid when the buffer grows.
+ */
+typedef struct
+{
+    char *text;
+    size_t text_size;
+    size_t text_capacity;
+    BufferedLine *lines;
+    int line_count;
+    int line_capacity;
+} LineBuffer;
+
+void line_buffer_init(LineBuffer *buffer);
+
+/* Appends a copy of line, remembering the source line it maps to. Returns 0 on success */
+int line_buffer_append(LineBuffer *buffer, const char *line, int source_line);
+
+/*
+ * Same for the len characters at line, which need not be '\0' terminated,
+ * with what is known about it; info->tokens must outlive the buffer's use.
+ */
+int line_buffer_append_span(LineBuffer *buffer, const char *line, size_t len, const LineInfo *info);
+
+/* Returns the text of line idx (valid until the next append or reset) */
+const char *line_buffer_line(const LineBuffer *buffer, int idx);
+
+/* Returns the original source line of line idx */
+int line_buffer_source_line(const LineBuffer *buffer, int idx);
+
+/* Returns what was appended along with line idx */
+const LineInfo *line_buffer_info(const LineBuffer *buffer, int idx);
+
+/* Writes every line to file. Returns 0 on success */
+int line_buffer_write(const LineBuffer *buffer, FILE *file);
+
+/* Forgets all lines, keeping the memory for reuse */
+void line_buffer_reset(LineBuffer *buffer);
+
+void line_buffer_free(LineBuffer *buffer);
+
+#endif /* LINE_BUFFER_H */
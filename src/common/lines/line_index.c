@@ -0,0 +1,103 @@
+/*
+ * line_index.c
+ *
+ * One scan over a source in memory that records where each line starts and
+ * what kind of line it is, so later stages never copy or re-split the text.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "line_index.h"
+#include "../keywords/keywords.h"
+
+#define INITIAL_INDEX_CAPACITY 256
+
+void line_index_init(LineIndex *index)
+{
+    index->lines = NULL;
+    index->count = 0;
+    index->capacity = 0;
+}
+
+static size_t skip_space(const char *line, size_t i, size_t len)
+{
+    while (i < len && isspace((unsigned char)line[i]))
+        i++;
+    return i;
+}
+
+LineKind classify_line(const char *line, size_t len)
+{
+    size_t i = skip_space(line, 0, len), start;
+    const Keyword *keyword;
+
+    /* a leading comma only marks a value as expected; a second one, or nothing, is a token itself */
+    if (i < len && line[i] == ',')
+    {
+        i = skip_space(line, i + 1, len);
+        if (i == len || line[i] == ',')
+            return LINE_CODE;
+    }
+
+    if (i == len)
+        return LINE_BLANK;
+    if (line[i] == ';')
+        return LINE_COMMENT;
+    if (strchr("[]()", line[i]))
+        return LINE_CODE;
+
+    /* the first word, delimited as the tokenizer does */
+    start = i;
+    while (i < len && !isspace((unsigned char)line[i]) && line[i] != ',' && line[i] != ';' &&
+           !strchr("()", line[i]))
+        i++;
+
+    keyword = keyword_lookup_span(line + start, i - start);
+    if (keyword && keyword->kind == KEYWORD_MACRO_START)
+        return LINE_MACRO_START;
+    if (keyword && keyword->kind == KEYWORD_MACRO_END)
+        return LINE_MACRO_END;
+    return LINE_CODE;
+}
+
+int line_index_build(LineIndex *index, const char *text, size_t length)
+{
+    size_t offset = 0;
+
+    index->count = 0;
+    while (offset < length)
+    {
+        const char *newline = memchr(text + offset, '\n', length - offset);
+        size_t end = newline ? (size_t)(newline - text) + 1 : length;
+        IndexedLine *line;
+
+        if (index->count == index->capacity)
+        {
+            int capacity = index->capacity ? index->capacity * 2 : INITIAL_INDEX_CAPACITY;
+            IndexedLine *lines = realloc(index->lines, sizeof(IndexedLine) * capacity);
+            if (!lines)
+                return -1;
+            index->lines = lines;
+            index->capacity = capacity;
+        }
+
+        line = &index->lines[index->count++];
+        line->offset = offset;
+        line->length = end - offset;
+        line->kind = classify_line(text + offset, line->length);
+        offset = end;
+    }
+    return 0;
+}
+
+void line_index_reset(LineIndex *index)
+{
+    index->count = 0;
+}
+
+void line_index_free(LineIndex *index)
+{
+    free(index->lines);
+    line_index_init(index);
+}
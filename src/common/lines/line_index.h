@@ -0,0 +1,57 @@
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <stddef.h>
+#include "../tokenizer/tokenizer.h"
+
+/* What a source line is, as far as the stages need to know before tokenizing it */
+typedef enum
+{
+    LINE_BLANK,       /* whitespace only */
+    LINE_COMMENT,     /* starts with ';' */
+    LINE_MACRO_START, /* starts with mcro */
+    LINE_MACRO_END,   /* starts with mcroend */
+    LINE_CODE         /* anything else; also used for lines nobody classified */
+} LineKind;
+
+/* One line of the source */
+typedef struct
+{
+    size_t offset; /* first character of the line in the source */
+    size_t length; /* including the newline, if the line has one */
+    LineKind kind;
+} IndexedLine;
+
+/*
+ * Where every line of a source in memory starts, and what it is. Built once
+ * per file by one scan over the text; line n of the file is lines[n - 1].
+ */
+typedef struct
+{
+    IndexedLine *lines;
+    int count;
+    int capacity;
+} LineIndex;
+
+/* What travels with a line of expanded source besides its text */
+typedef struct
+{
+    int source_line;      /* line of the original .as file this line came from */
+    LineKind kind;
+    const Tokens *tokens; /* the line already tokenized, or NULL */
+} LineInfo;
+
+void line_index_init(LineIndex *index);
+
+/* Indexes the length bytes of text (not necessarily '\0' terminated). Returns 0 on success, -1 if out of memory */
+int line_index_build(LineIndex *index, const char *text, size_t length);
+
+/* Classifies the len bytes of one line the way the tokenizer would split it */
+LineKind classify_line(const char *line, size_t len);
+
+/* Forgets all lines, keeping the memory for reuse */
+void line_index_reset(LineIndex *index);
+
+void line_index_free(LineIndex *index);
+
+#endif
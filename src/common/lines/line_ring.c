@@ -0,0 +1,100 @@
+/*
+ * line_ring.c
+ *
+ * Bounded ring of lines between the pre-assembler thread and the first pass.
+ */
+
+#include <stdlib.h>
+#include "line_ring.h"
+
+int line_ring_init(LineRing *ring, int capacity)
+{
+    ring->slots = malloc(sizeof(RingSlot) * capacity);
+    if (!ring->slots)
+        return -1;
+
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = 0;
+    ring->is_closed = 0;
+    ring->is_cancelled = 0;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->not_empty, NULL);
+    pthread_cond_init(&ring->not_full, NULL);
+    return 0;
+}
+
+void line_ring_push_span(LineRing *ring, const char *line, size_t len, const LineInfo *info)
+{
+    RingSlot *slot;
+
+    pthread_mutex_lock(&ring->lock);
+    while (ring->count == ring->capacity && !ring->is_cancelled)
+        pthread_cond_wait(&ring->not_full, &ring->lock);
+
+    if (!ring->is_cancelled)
+    {
+        slot = &ring->slots[(ring->head + ring->count) % ring->capacity];
+        slot->text = line;
+        slot->length = len;
+        slot->info = *info;
+
+        /* only an empty ring can have a waiting consumer */
+        if (ring->count++ == 0)
+            pthread_cond_signal(&ring->not_empty);
+    }
+    pthread_mutex_unlock(&ring->lock);
+}
+
+void line_ring_close(LineRing *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->is_closed = 1;
+    pthread_cond_signal(&ring->not_empty);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+void line_ring_cancel(LineRing *ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->is_cancelled = 1;
+    ring->count = 0;
+    pthread_cond_signal(&ring->not_full);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+int line_ring_pop(LineRing *ring, const char **line, size_t *length, LineInfo *info)
+{
+    RingSlot *slot;
+
+    pthread_mutex_lock(&ring->lock);
+    while (ring->count == 0 && !ring->is_closed && !ring->is_cancelled)
+        pthread_cond_wait(&ring->not_empty, &ring->lock);
+
+    if (ring->count == 0)
+    {
+        pthread_mutex_unlock(&ring->lock);
+        return 0;
+    }
+
+    slot = &ring->slots[ring->head];
+    *line = slot->text;
+    *length = slot->length;
+    *info = slot->info;
+    ring->head = (ring->head + 1) % ring->capacity;
+
+    /* only a full ring can have a waiting producer */
+    if (ring->count-- == ring->capacity)
+        pthread_cond_signal(&ring->not_full);
+    pthread_mutex_unlock(&ring->lock);
+    return 1;
+}
+
+void line_ring_destroy(LineRing *ring)
+{
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->not_empty);
+    pthread_cond_destroy(&ring->not_full);
+    free(ring->slots);
+    ring->slots = NULL;
+}
@@ -0,0 +1,62 @@
+#ifndef LINE_RING_H
+#define LINE_RING_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "line_index.h"
+
+#define LINE_RING_CAPACITY 256 /* lines in flight between producer and consumer */
+
+/* One line in flight: a span of text owned by the producer, not a copy */
+typedef struct
+{
+    const char *text;
+    size_t length;
+    LineInfo info;
+} RingSlot;
+
+/*
+ * Bounded single-producer / single-consumer queue of lines.
+ * The producer blocks while the ring is full and the consumer blocks while
+ * it is empty, so the two sides run concurrently with a fixed memory budget.
+ * The producer closes the ring when it is done; the consumer cancels it when
+ * it stops reading early, after which pushes are dropped instead of blocking.
+ */
+typedef struct
+{
+    RingSlot *slots;
+    int capacity;
+    int head;  /* next slot to pop */
+    int count; /* slots currently filled */
+    int is_closed;
+    int is_cancelled;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} LineRing;
+
+/* Returns 0 on success, -1 if out of memory */
+int line_ring_init(LineRing *ring, int capacity);
+
+/*
+ * Queues the len characters at line, which need not be '\0' terminated,
+ * along with what the producer knows about it. Only the span is queued, so
+ * the text must stay in place until the consumer has popped it.
+ */
+void line_ring_push_span(LineRing *ring, const char *line, size_t len, const LineInfo *info);
+
+/* Marks the end of the input; pops drain what is left, then return 0 */
+void line_ring_close(LineRing *ring);
+
+/* Stops the consumer side; pending and future lines are discarded */
+void line_ring_cancel(LineRing *ring);
+
+/*
+ * Hands out the next span in line and length, and what was pushed with it in
+ * info. Returns 1 on success, 0 once the ring is closed and empty.
+ */
+int line_ring_pop(LineRing *ring, const char **line, size_t *length, LineInfo *info);
+
+void line_ring_destroy(LineRing *ring);
+
+#endif
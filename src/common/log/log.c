@@ -0,0 +1,75 @@
+/*
+ * log.c
+ *
+ * Global log level and category filter, see log.h.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "log.h"
+
+static const char *category_names[LOG_CATEGORY_COUNT] = {
+    "general", "preprocessor", "first_pass", "second_pass", "encoding", "output"};
+
+static LogLevel current_level = LOG_DEFAULT_LEVEL;
+static int category_enabled[LOG_CATEGORY_COUNT] = {1, 1, 1, 1, 1, 1};
+
+void log_set_level(LogLevel level)
+{
+    current_level = level;
+}
+
+LogLevel log_get_level(void)
+{
+    return current_level;
+}
+
+int log_set_categories(const char *names)
+{
+    int selected[LOG_CATEGORY_COUNT];
+    const char *name = names;
+    int i;
+
+    for (i = 0; i < LOG_CATEGORY_COUNT; i++)
+        selected[i] = 0;
+
+    while (*name)
+    {
+        size_t len = strcspn(name, ",");
+        for (i = 0; i < LOG_CATEGORY_COUNT; i++)
+        {
+            if (strlen(category_names[i]) == len && strncmp(name, category_names[i], len) == 0)
+                break;
+        }
+        if (i == LOG_CATEGORY_COUNT)
+            return -1;
+        selected[i] = 1;
+
+        name += len;
+        if (*name == ',')
+            name++;
+    }
+
+    for (i = 0; i < LOG_CATEGORY_COUNT; i++)
+        category_enabled[i] = selected[i];
+    return 0;
+}
+
+int log_is_enabled(LogLevel level, LogCategory category)
+{
+    if (level > current_level)
+        return 0;
+
+    /* the category filter only narrows the chatty levels */
+    return level < LOG_LEVEL_DEBUG || category_enabled[category];
+}
+
+void log_printf(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vfprintf(stdout, format, args);
+    va_end(args);
+}
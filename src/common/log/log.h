@@ -0,0 +1,74 @@
+#ifndef LOG_H
+#define LOG_H
+
+/*
+ * Leveled, categorized progress and debug output.
+ *
+ * C90 has no variadic macros, so the printf arguments are passed as one
+ * parenthesized group:
+ *
+ *     LOG_INFO(LOG_PREPROCESSOR, ("Preprocessing: %s\n", path));
+ *
+ * The arguments are only evaluated when the message is enabled.
+ * LOG_TRACE compiles to nothing when NDEBUG is defined (make RELEASE=1).
+ * The level and categories are set once at startup, before any thread starts.
+ */
+
+typedef enum
+{
+    LOG_LEVEL_ERROR,   /* internal failures; shown even with --quiet */
+    LOG_LEVEL_WARNING, /* default */
+    LOG_LEVEL_INFO,    /* one line per file and stage (-v) */
+    LOG_LEVEL_DEBUG,   /* tables and per-statement details (-vv) */
+    LOG_LEVEL_TRACE    /* every line, token and word (-vvv, debug builds only) */
+} LogLevel;
+
+typedef enum
+{
+    LOG_GENERAL,
+    LOG_PREPROCESSOR,
+    LOG_FIRST_PASS,
+    LOG_SECOND_PASS,
+    LOG_ENCODING,
+    LOG_OUTPUT,
+    LOG_CATEGORY_COUNT
+} LogCategory;
+
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_WARNING
+
+void log_set_level(LogLevel level);
+LogLevel log_get_level(void);
+
+/*
+ * Limits debug and trace output to a comma separated list of category names
+ * (e.g. "first_pass,encoding"). Returns 0 on success, -1 on an unknown name.
+ */
+int log_set_categories(const char *names);
+
+/* Returns 1 if a message of this level and category would be printed */
+int log_is_enabled(LogLevel level, LogCategory category);
+
+/* Writes to the log stream unconditionally; use the LOG_* macros instead */
+void log_printf(const char *format, ...);
+
+#define LOG_AT(level, category, args)              \
+    do                                             \
+    {                                              \
+        if (log_is_enabled((level), (category)))   \
+            log_printf args;                       \
+    } while (0)
+
+#define LOG_ERROR(category, args) LOG_AT(LOG_LEVEL_ERROR, category, args)
+#define LOG_WARNING(category, args) LOG_AT(LOG_LEVEL_WARNING, category, args)
+#define LOG_INFO(category, args) LOG_AT(LOG_LEVEL_INFO, category, args)
+#define LOG_DEBUG(category, args) LOG_AT(LOG_LEVEL_DEBUG, category, args)
+
+#ifdef NDEBUG
+#define LOG_TRACE(category, args) ((void)0)
+#define LOG_TRACE_ENABLED(category) 0
+#else
+#define LOG_TRACE(category, args) LOG_AT(LOG_LEVEL_TRACE, category, args)
+#define LOG_TRACE_ENABLED(category) log_is_enabled(LOG_LEVEL_TRACE, (category))
+#endif
+
+#endif
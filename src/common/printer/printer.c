@@ -4,49 +4,49 @@ void print_symbol(const char *key, void *data)
 {
     SymbolInfo *info = (SymbolInfo *)data;
 
-    printf("  [%s] Address: %d, Type: ",
-           key,
-           info->address);
+    log_printf("  [%s] Address: %d, Type: ",
+               key,
+               info->address);
 
     switch (info->type)
     {
     case SYMBOL_CODE:
-        printf("CODE");
+        log_printf("CODE");
         break;
     case SYMBOL_DATA:
-        printf("DATA");
+        log_printf("DATA");
         break;
     case SYMBOL_EXTERN:
-        printf("EXTERN");
+        log_printf("EXTERN");
         break;
     case SYMBOL_ENTRY:
-        printf("ENTRY");
+        log_printf("ENTRY");
         break;
     default:
-        printf("UNKNOWN");
+        log_printf("UNKNOWN");
         break;
     }
-    printf("\n");
+    log_printf("\n");
 }
 
 void print_extern(const char *key, void *data)
 {
     if (!key || !data)
     {
-        printf("Invalid extern data\n");
+        log_printf("Invalid extern data\n");
         return;
     }
     int address = *(int *)data;
-    printf("  [EXTERN] %s @ %d\n", key, address);
+    log_printf("  [EXTERN] %s @ %d\n", key, address);
 }
 
 void print_entry(const char *key, void *data)
 {
     if (!key || !data)
     {
-        printf("Invalid extern data\n");
+        log_printf("Invalid extern data\n");
         return;
     }
     int address = *(int *)data;
-    printf("  [ENTRY] %s @ %d\n", key, address);
+    log_printf("  [ENTRY] %s @ %d\n", key, address);
 }
@@ -11,7 +11,7 @@ typedef enum
 
 typedef struct SymbolInfo
 {
-    char name[31];
+    const char *name; /* interned label, shared with the symbol table key */
     int address;
     SymbolType type;
     int is_entry;
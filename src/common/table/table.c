@@ -2,7 +2,8 @@
  * table.c
  *
  * Implementation of the generic table module.
- * The table is implemented as a singly linked list.
+ * Entries live on a singly linked list (which fixes the iteration order) and
+ * are found through an open-addressing hash index with linear probing.
  */
 
 #include "table.h"
@@ -10,16 +11,96 @@
 #include <string.h>
 #include <stdio.h>
 
+/* Initial size of the hash index; the index doubles once it is 70% full */
+#define TABLE_INITIAL_SLOTS 64
+
 /**
- * @brief The internal structure for a single node in the linked list.
- *
- * Each node holds a key, a pointer to the data (value), and a pointer
- * to the next node in the list.
+ * @brief FNV-1a hash of a key string.
+ */
+static unsigned long table_hash(const char *key)
+{
+    unsigned long hash = 2166136261UL;
+
+    while (*key)
+    {
+        hash ^= (unsigned char)*key++;
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hashes an interned key by its address.
+ */
+static unsigned long table_hash_pointer(const char *key)
+{
+    unsigned long bits = (unsigned long)(size_t)key;
+
+    /* drop the alignment bits, then spread the rest over the index */
+    bits >>= 3;
+    return (bits * 2654435761UL) & 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief Hashes a key the way this table compares keys.
  */
+static unsigned long table_key_hash(const Table *table, const char *key)
+{
+    return table->interned_keys ? table_hash_pointer(key) : table_hash(key);
+}
+
+/**
+ * @brief Returns the index slot holding `key`, or the free slot where it belongs.
+ */
+static TableNode **table_find_slot(const Table *table, const char *key, unsigned long hash)
+{
+    size_t mask = table->slot_count - 1;
+    size_t i = (size_t)hash & mask;
+
+    while (table->slots[i] != NULL)
+    {
+        TableNode *node = table->slots[i];
+        if (node->key == key ||
+            (!table->interned_keys && node->hash == hash && strcmp(node->key, key) == 0))
+        {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return &table->slots[i];
+}
 
 /**
- * @brief The main table structure that holds the linked list.
+ * @brief Doubles the hash index and re-inserts every node into it.
  */
+static bool table_grow(Table *table)
+{
+    size_t new_count = table->slot_count * 2;
+    TableNode **new_slots = (TableNode **)calloc(new_count, sizeof(TableNode *));
+    TableNode *current;
+    size_t i;
+
+    if (new_slots == NULL)
+    {
+        perror("Failed to grow the table index");
+        return false;
+    }
+
+    for (current = table->head; current != NULL; current = current->next)
+    {
+        i = (size_t)current->hash & (new_count - 1);
+        while (new_slots[i] != NULL)
+        {
+            i = (i + 1) & (new_count - 1);
+        }
+        new_slots[i] = current;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->slot_count = new_count;
+    return true;
+}
 
 /**
  * @brief Creates and initializes a new, empty table.
@@ -36,6 +117,30 @@ Table *table_create()
 
     /* Initialize the table to be empty */
     table->head = NULL;
+    table->count = 0;
+    table->interned_keys = false;
+    table->slot_count = TABLE_INITIAL_SLOTS;
+    table->slots = (TableNode **)calloc(table->slot_count, sizeof(TableNode *));
+    if (table->slots == NULL)
+    {
+        perror("Failed to allocate memory for table index");
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+/**
+ * @brief Creates a table keyed by interned strings.
+ */
+Table *table_create_interned()
+{
+    Table *table = table_create();
+
+    if (table != NULL)
+    {
+        table->interned_keys = true;
+    }
     return table;
 }
 
@@ -43,6 +148,23 @@ Table *table_create()
  * @brief Destroys a table and frees all associated memory.
  */
 void table_destroy(Table *table, void (*free_data_func)(void *))
+{
+    if (table == NULL)
+    {
+        return;
+    }
+
+    table_clear(table, free_data_func);
+
+    /* Finally, free the index and the table container */
+    free(table->slots);
+    free(table);
+}
+
+/**
+ * @brief Removes all entries from a table, keeping the table itself.
+ */
+void table_clear(Table *table, void (*free_data_func)(void *))
 {
     TableNode *current;
     TableNode *next;
@@ -58,7 +180,10 @@ void table_destroy(Table *table, void (*free_data_func)(void *))
         next = current->next;
 
         /* Free the key string (which was duplicated during insertion) */
-        free(current->key);
+        if (!table->interned_keys)
+        {
+            free(current->key);
+        }
 
         /* If a free function is provided, use it to free the data */
         if (free_data_func != NULL)
@@ -71,8 +196,10 @@ void table_destroy(Table *table, void (*free_data_func)(void *))
         current = next;
     }
 
-    /* Finally, free the table container */
-    free(table);
+    /* The table is empty again and ready for reuse; the index keeps its size */
+    table->head = NULL;
+    table->count = 0;
+    memset(table->slots, 0, table->slot_count * sizeof(TableNode *));
 }
 
 /**
@@ -81,14 +208,24 @@ void table_destroy(Table *table, void (*free_data_func)(void *))
 bool table_insert(Table *table, const char *key, void *data)
 {
     TableNode *new_node;
+    TableNode **slot;
+    unsigned long hash;
 
     if (table == NULL || key == NULL)
     {
         return false;
     }
 
-    /* First, check if the key already exists to prevent duplicates */
-    if (table_lookup(table, key) != NULL)
+    /* Keep the index at most 70% full so probe runs stay short */
+    if ((table->count + 1) * 10 > table->slot_count * 7 && !table_grow(table))
+    {
+        return false;
+    }
+
+    /* One probe finds either the existing key (a duplicate) or its free slot */
+    hash = table_key_hash(table, key);
+    slot = table_find_slot(table, key, hash);
+    if (*slot != NULL)
     {
         fprintf(stderr, "Error: Key '%s' already exists in the table.\n", key);
         return false;
@@ -102,23 +239,33 @@ bool table_insert(Table *table, const char *key, void *data)
         return false;
     }
 
-    /* Duplicate the key string to be stored in the table */
-    /* strdup is equivalent to malloc + strcpy */
-    new_node->key = (char *)malloc(strlen(key) + 1);
-    if (new_node->key == NULL)
+    /* Duplicate the key string to be stored in the table (interned keys are shared) */
+    if (table->interned_keys)
     {
-        perror("Failed to allocate memory for key");
-        free(new_node); /* Clean up the allocated node */
-        return false;
+        new_node->key = (char *)key;
+    }
+    else
+    {
+        /* strdup is equivalent to malloc + strcpy */
+        new_node->key = (char *)malloc(strlen(key) + 1);
+        if (new_node->key == NULL)
+        {
+            perror("Failed to allocate memory for key");
+            free(new_node); /* Clean up the allocated node */
+            return false;
+        }
+        strcpy(new_node->key, key);
     }
-    strcpy(new_node->key, key);
 
     /* Set the data pointer */
     new_node->data = data;
+    new_node->hash = hash;
 
-    /* Insert the new node at the beginning of the list */
+    /* Insert the new node at the beginning of the list and index it */
     new_node->next = table->head;
     table->head = new_node;
+    *slot = new_node;
+    table->count++;
 
     return true;
 }
@@ -128,25 +275,15 @@ bool table_insert(Table *table, const char *key, void *data)
  */
 void *table_lookup(Table *table, const char *key)
 {
-    TableNode *current;
+    TableNode *node;
 
     if (table == NULL || key == NULL)
     {
         return NULL;
     }
 
-    current = table->head;
-    while (current != NULL)
-    {
-        /* Compare the keys */
-        if (strcmp(current->key, key) == 0)
-        {
-            return current->data; /* Key found, return the data */
-        }
-        current = current->next;
-    }
-
-    return NULL; /* Key not found */
+    node = *table_find_slot(table, key, table_key_hash(table, key));
+    return node != NULL ? node->data : NULL; /* NULL when the key is not found */
 }
 
 /**
@@ -3,7 +3,9 @@
  *
  * Defines the interface for a generic symbol table module.
  *
- * This module provides a generic key-value store, implemented as a linked list.
+ * This module provides a generic key-value store. Entries are kept on a linked
+ * list, which fixes the iteration order (newest entry first), and are indexed by
+ * an open-addressing hash table, so insert and lookup are O(1) on average.
  * It's designed to be reusable for different tables needed in the assembler,
  * such as the symbol table and the macro table.
  *
@@ -17,11 +19,13 @@
 #define TABLE_H
 
 #include <stdbool.h> /* For the bool type */
+#include <stddef.h>  /* For size_t */
 
 typedef struct TableNode
 {
     char *key;              /* The key for this entry (string) */
     void *data;             /* Pointer to the associated data */
+    unsigned long hash;     /* Hash of the key, kept so growing never rehashes strings */
     struct TableNode *next; /* Pointer to the next node in the table */
 } TableNode;
 
@@ -31,7 +35,11 @@ typedef struct TableNode
  */
 typedef struct Table
 {
-    TableNode *head; /* Pointer to the first node in the list */
+    TableNode *head;      /* Pointer to the first node in the list */
+    TableNode **slots;    /* Open-addressing index into the list, NULL marks a free slot */
+    size_t slot_count;    /* Size of `slots`, always a power of two */
+    size_t count;         /* Number of entries in the table */
+    bool interned_keys;   /* Keys are borrowed interned strings, compared by pointer */
 } Table;
 
 /**
@@ -41,6 +49,17 @@ typedef struct Table
  */
 Table *table_create();
 
+/**
+ * @brief Creates a table whose keys all come from one Interner.
+ *
+ * Keys are stored as given (never copied or freed) and compared by pointer,
+ * so lookups must also pass interned strings. The interner must outlive
+ * the table's entries.
+ *
+ * @return A pointer to the newly created table, or NULL if memory allocation fails.
+ */
+Table *table_create_interned();
+
 /**
  * @brief Destroys a table and frees all associated memory.
  *
@@ -55,6 +74,17 @@ Table *table_create();
  */
 void table_destroy(Table *table, void (*free_data_func)(void *));
 
+/**
+ * @brief Removes all entries from a table without destroying it.
+ *
+ * Frees every key and node exactly like `table_destroy`, but leaves the table
+ * container allocated and empty, so it can be reused (e.g. for the next input file).
+ *
+ * @param table The table to clear.
+ * @param free_data_func Same as in `table_destroy`; may be NULL.
+ */
+void table_clear(Table *table, void (*free_data_func)(void *));
+
 /**
  * @brief Inserts a new key-value pair into the table.
  *
@@ -82,6 +112,8 @@ void *table_lookup(Table *table, const char *key);
 /**
  * @brief Iterates over each entry in the table and applies a callback function.
  *
+ * Entries are visited newest first, independent of the hash index, so
+ * anything generated from the table comes out in a stable order.
  * This allows processing all elements without exposing the internal structure
  * of the table.
  *
@@ -0,0 +1,142 @@
+/*
+ * text_buffer.c
+ *
+ * Growable text block; the output stage formats .ob/.ent/.ext into these
+ * so the result can be written to disk or handed to a library caller.
+ */
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "text_buffer.h"
+
+#define INITIAL_TEXT_CAPACITY 1024
+
+/* Makes room for extra more bytes plus the terminator. Returns 0 on success */
+static int reserve(TextBuffer *buffer, size_t extra)
+{
+    size_t new_capacity;
+    char *new_data;
+
+    if (buffer->size + extra + 1 <= buffer->capacity)
+        return 0;
+
+    new_capacity = buffer->capacity ? buffer->capacity : INITIAL_TEXT_CAPACITY;
+    while (buffer->size + extra + 1 > new_capacity)
+        new_capacity *= 2;
+
+    new_data = realloc(buffer->data, new_capacity);
+    if (!new_data)
+        return -1;
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return 0;
+}
+
+int text_buffer_reserve(TextBuffer *buffer, size_t extra)
+{
+    return reserve(buffer, extra);
+}
+
+void text_buffer_init(TextBuffer *buffer)
+{
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+}
+
+char *text_buffer_extend(TextBuffer *buffer, size_t len)
+{
+    char *start;
+
+    if (reserve(buffer, len) != 0)
+        return NULL;
+
+    start = buffer->data + buffer->size;
+    buffer->size += len;
+    buffer->data[buffer->size] = '\0';
+    return start;
+}
+
+int text_buffer_append(TextBuffer *buffer, const char *text, size_t len)
+{
+    if (reserve(buffer, len) != 0)
+        return -1;
+
+    memcpy(buffer->data + buffer->size, text, len);
+    buffer->size += len;
+    buffer->data[buffer->size] = '\0';
+    return 0;
+}
+
+int text_buffer_printf(TextBuffer *buffer, const char *format, ...)
+{
+    va_list args;
+    int len;
+
+    /* measure first, then format in place */
+    va_start(args, format);
+    len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (len < 0 || reserve(buffer, (size_t)len) != 0)
+        return -1;
+
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->size, (size_t)len + 1, format, args);
+    va_end(args);
+    buffer->size += (size_t)len;
+    return 0;
+}
+
+int text_buffer_write_file(const TextBuffer *buffer, const char *path)
+{
+    size_t written = 0;
+    int fd;
+
+    /* replace rather than truncate, so a hard link (e.g. into the build cache) is never written through */
+    remove(path);
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+        return -1;
+
+    /* one write normally takes it all; loop only for short writes and signals */
+    while (written < buffer->size)
+    {
+        ssize_t count = write(fd, buffer->data + written, buffer->size - written);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+        {
+            close(fd);
+            return -1;
+        }
+        written += (size_t)count;
+    }
+    return close(fd) != 0 ? -1 : 0;
+}
+
+char *text_buffer_detach(TextBuffer *buffer, size_t *size)
+{
+    char *data = buffer->data;
+
+    if (size)
+        *size = buffer->size;
+    text_buffer_init(buffer);
+    return data;
+}
+
+void text_buffer_reset(TextBuffer *buffer)
+{
+    buffer->size = 0;
+    if (buffer->data)
+        buffer->data[0] = '\0';
+}
+
+void text_buffer_free(TextBuffer *buffer)
+{
+    free(buffer->data);
+    text_buffer_init(buffer);
+}
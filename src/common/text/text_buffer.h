@@ -0,0 +1,47 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/* A growable block of text, used to build output files in memory */
+typedef struct
+{
+    char *data;      /* always '\0' terminated once anything was appended */
+    size_t size;     /* bytes used, excluding the terminator */
+    size_t capacity;
+} TextBuffer;
+
+void text_buffer_init(TextBuffer *buffer);
+
+/* Makes room for extra more bytes, so appends up to that size do not grow the buffer. Returns 0 on success */
+int text_buffer_reserve(TextBuffer *buffer, size_t extra);
+
+/*
+ * Grows the buffer by len bytes and returns them for the caller to fill in
+ * place (the terminator after them is already written). Returns NULL if out
+ * of memory.
+ */
+char *text_buffer_extend(TextBuffer *buffer, size_t len);
+
+/* Appends len bytes of text. Returns 0 on success, -1 if out of memory */
+int text_buffer_append(TextBuffer *buffer, const char *text, size_t len);
+
+/* Appends printf-style formatted text. Returns 0 on success, -1 on failure */
+int text_buffer_printf(TextBuffer *buffer, const char *format, ...);
+
+/*
+ * Replaces the file at path with the buffer contents, handed to the system
+ * in one write. Returns 0 on success, -1 on failure.
+ */
+int text_buffer_write_file(const TextBuffer *buffer, const char *path);
+
+/* Hands the memory to the caller (who frees it) and leaves the buffer empty */
+char *text_buffer_detach(TextBuffer *buffer, size_t *size);
+
+/* Empties the buffer, keeping its memory for reuse */
+void text_buffer_reset(TextBuffer *buffer);
+
+void text_buffer_free(TextBuffer *buffer);
+
+#endif
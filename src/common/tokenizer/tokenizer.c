@@ -1,31 +1,93 @@
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdio.h>
 #include "tokenizer.h"
 
-Tokens tokenize_line(const char *line)
+/* returned for tokens past the end of the line */
+static char no_token[1] = "";
+
+void tokens_init(Tokens *tokens)
+{
+    tokens->line = NULL;
+    tokens->spans = NULL;
+    tokens->count = 0;
+    tokens->capacity = 0;
+    tokens->text = NULL;
+    tokens->text_size = 0;
+}
+
+/*
+ * Makes room for the tokens of a line of len bytes: every token but the
+ * last one or two consumes at least one byte, and each one adds a '\0'.
+ * Returns 0 on success, -1 if out of memory.
+ */
+static int reserve(Tokens *tokens, size_t len)
+{
+    size_t max_tokens = len + 2;
+    size_t text_size = len + max_tokens + 1;
+
+    if ((size_t)tokens->capacity < max_tokens)
+    {
+        Token *spans = realloc(tokens->spans, max_tokens * sizeof(Token));
+        if (!spans)
+            return -1;
+        tokens->spans = spans;
+        tokens->capacity = (int)max_tokens;
+    }
+
+    if (tokens->text_size < text_size)
+    {
+        char *text = realloc(tokens->text, text_size);
+        if (!text)
+            return -1;
+        tokens->text = text;
+        tokens->text_size = text_size;
+    }
+    return 0;
+}
+
+/* Records the span and lays its text out after the previous token's */
+static void add_token(Tokens *tokens, size_t offset, size_t length, TokenKind kind)
 {
-    Tokens result;
-    memset(&result, 0, sizeof(Tokens));
-    int i = 0, len = strlen(line);
+    Token *token = &tokens->spans[tokens->count];
+    char *text = tokens->text + offset + tokens->count;
+
+    token->offset = (int)offset;
+    token->length = (int)length;
+    token->kind = kind;
+    memcpy(text, tokens->line + offset, length);
+    text[length] = '\0';
+    tokens->count++;
+}
+
+int tokenize_line(Tokens *tokens, const char *line)
+{
+    return tokenize_span(tokens, line, strlen(line));
+}
+
+int tokenize_span(Tokens *tokens, const char *line, size_t len)
+{
+    size_t i = 0;
     int expecting_value = 0;
 
-    while (i < len && result.count < MAX_TOKENS)
+    tokens->line = line;
+    tokens->count = 0;
+    if (reserve(tokens, len) != 0)
+        return -1;
+
+    while (i < len)
     {
-        int j = 0;
+        size_t start;
 
         /* Skip whitespace */
-        while (i < len && isspace(line[i]))
+        while (i < len && isspace((unsigned char)line[i]))
             i++;
 
         /* Handle comment */
         if (i < len && line[i] == ';')
         {
-            j = 0;
-            while (i < len && j < MAX_TOKEN_LEN - 1)
-                result.tokens[result.count][j++] = line[i++];
-            result.tokens[result.count][j] = '\0';
-            result.count++;
+            add_token(tokens, i, len - i, TOKEN_COMMENT);
             break;
         }
 
@@ -34,9 +96,9 @@ Tokens tokenize_line(const char *line)
         {
             if (expecting_value)
             {
-                strcpy(result.tokens[result.count++], ",");
+                add_token(tokens, i, 1, TOKEN_MISSING_VALUE);
             }
-            expecting_value = 1; 
+            expecting_value = 1;
             i++;
             continue;
         }
@@ -44,36 +106,74 @@ Tokens tokenize_line(const char *line)
         /* Handle special one-char tokens */
         if (i < len && strchr("[]()", line[i]))
         {
-            result.tokens[result.count][0] = line[i];
-            result.tokens[result.count][1] = '\0';
-            result.count++;
+            add_token(tokens, i, 1, TOKEN_BRACKET);
             i++;
             expecting_value = 0;
             continue;
         }
 
-        /* If we reach here, it's a real token */
-        j = 0;
+        /* If we reach here, it's a real token (empty after trailing whitespace) */
+        start = i;
         while (
             i < len &&
-            !isspace(line[i]) &&
+            !isspace((unsigned char)line[i]) &&
             line[i] != ',' &&
             line[i] != ';' &&
-            !strchr("()", line[i]) &&
-            j < MAX_TOKEN_LEN - 1)
+            !strchr("()", line[i]))
         {
-            result.tokens[result.count][j++] = line[i++];
+            i++;
         }
-        result.tokens[result.count][j] = '\0';
-        result.count++;
+        add_token(tokens, start, i - start, TOKEN_WORD);
         expecting_value = 0;
     }
 
     /* סוף שורה נגמרה בפסיק? סימן שחסרה מחרוזת אחרי */
-    if (expecting_value && result.count < MAX_TOKENS)
+    if (expecting_value)
     {
-        strcpy(result.tokens[result.count++], "");
+        add_token(tokens, len, 0, TOKEN_TRAILING_COMMA);
     }
 
-    return result;
+    return 0;
+}
+
+char *token_text(const Tokens *tokens, int idx)
+{
+    if (idx < 0 || idx >= tokens->count)
+        return no_token;
+    return tokens->text + tokens->spans[idx].offset + idx;
+}
+
+const Tokens *tokens_snapshot(Arena *arena, const Tokens *tokens, const char *line)
+{
+    Tokens *copy = arena_alloc(arena, sizeof(Tokens));
+    const Token *last;
+
+    if (!copy)
+        return NULL;
+
+    tokens_init(copy);
+    copy->line = line;
+    if (tokens->count == 0)
+        return copy;
+
+    /* the text of the last token ends the used part of the text buffer */
+    last = &tokens->spans[tokens->count - 1];
+    copy->text_size = (size_t)last->offset + last->length + tokens->count;
+    copy->spans = arena_alloc(arena, tokens->count * sizeof(Token));
+    copy->text = arena_alloc(arena, copy->text_size);
+    if (!copy->spans || !copy->text)
+        return NULL;
+
+    memcpy(copy->spans, tokens->spans, tokens->count * sizeof(Token));
+    memcpy(copy->text, tokens->text, copy->text_size);
+    copy->count = tokens->count;
+    copy->capacity = tokens->count;
+    return copy;
+}
+
+void tokens_free(Tokens *tokens)
+{
+    free(tokens->spans);
+    free(tokens->text);
+    tokens_init(tokens);
 }
@@ -1,23 +1,74 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 
-#define MAX_TOKENS 64
+#include <stddef.h>
+#include "../arena/arena.h"
+
+/* Longest token prefix the operand validators copy for inspection */
 #define MAX_TOKEN_LEN 64
 
-typedef struct {
-    char tokens[MAX_TOKENS][MAX_TOKEN_LEN];
+typedef enum
+{
+    TOKEN_WORD,          /* mnemonic, label, operand or value; empty at the end of a line */
+    TOKEN_BRACKET,       /* one of [ ] ( ) */
+    TOKEN_COMMENT,       /* ';' up to the end of the line */
+    TOKEN_MISSING_VALUE, /* "," standing for the empty value between two commas */
+    TOKEN_TRAILING_COMMA /* "" standing for the value missing after a final comma */
+} TokenKind;
+
+/* A token as a span of the tokenized line */
+typedef struct
+{
+    int offset; /* first byte of the token in the line */
+    int length;
+    TokenKind kind;
+} Token;
+
+/*
+ * The tokens of one line. The spans point into the line itself; the text of
+ * every token is also kept '\0' terminated in one buffer so the parsers can
+ * use string functions on it. Both arrays are reused from line to line and
+ * only grow for a longer line, so there is no cap on token count or length.
+ */
+typedef struct
+{
+    const char *line; /* the line last tokenized (not owned) */
+    Token *spans;
     int count;
+    int capacity;     /* spans allocated */
+    char *text;       /* text of span i starts at text + spans[i].offset + i */
+    size_t text_size;
 } Tokens;
 
+void tokens_init(Tokens *tokens);
+
 /**
  * Tokenizes a line from the assembly source.
  * Tokens are separated by spaces, tabs, or commas.
  * Preserves special tokens like brackets, colons, and hash.
- * Does not modify the original input string.
+ * Does not modify the original input string, which must stay valid while
+ * the spans are used.
  *
+ * @param tokens Receives the tokens, replacing those of the previous line.
  * @param line The input line to tokenize.
- * @return A Tokens struct containing all extracted tokens.
+ * @return 0 on success, -1 if out of memory (tokens is then empty).
  */
-Tokens tokenize_line(const char *line);
+int tokenize_line(Tokens *tokens, const char *line);
+
+/* Same for the len characters at line, which need not be '\0' terminated */
+int tokenize_span(Tokens *tokens, const char *line, size_t len);
+
+/* Text of token idx, or "" when the line has fewer tokens */
+char *token_text(const Tokens *tokens, int idx);
+
+/*
+ * Copies the tokens of a line into arena, sized exactly, so they can be read
+ * again for as long as the arena lives. The copy's spans refer to line, an
+ * identical copy of the tokenized line that outlives it. The copy must not
+ * be tokenized into. Returns NULL if out of memory.
+ */
+const Tokens *tokens_snapshot(Arena *arena, const Tokens *tokens, const char *line);
+
+void tokens_free(Tokens *tokens);
 
 #endif
@@ -1,4 +1,5 @@
 #include "file_utils.h"
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -6,6 +7,10 @@
 #ifdef _WIN32
 #include <direct.h> /* mkdir Windows */
 #define mkdir(dir, mode) _mkdir(dir)
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 int extract_basename_no_ext(const char *input_path, char *output_basename, size_t max_len)
@@ -37,11 +42,6 @@ int extract_basename_no_ext(const char *input_path, char *output_basename, size_
     return 0;
 }
 
-void make_output_path(const char *output_basename, char *output_path, size_t max_len)
-{
-    snprintf(output_path, max_len, "output/%s.am", output_basename);
-}
-
 int ensure_directory_exists(const char *directory_path)
 {
     struct stat st = {0};
@@ -59,3 +59,112 @@ int ensure_directory_exists(const char *directory_path)
     }
     return 0;
 }
+
+char *read_file_contents(const char *path, size_t *length)
+{
+    FILE *file = fopen(path, "rb");
+    char *contents = NULL;
+    size_t size = 0, capacity = 0, count;
+
+    if (!file)
+        return NULL;
+
+    /* grow while reading, so pipes and special files work too */
+    do
+    {
+        if (size + 1 >= capacity)
+        {
+            char *grown;
+            capacity = capacity ? capacity * 2 : 4096;
+            grown = realloc(contents, capacity);
+            if (!grown)
+            {
+                free(contents);
+                fclose(file);
+                return NULL;
+            }
+            contents = grown;
+        }
+        count = fread(contents + size, 1, capacity - size - 1, file);
+        size += count;
+    } while (count > 0);
+
+    if (ferror(file))
+    {
+        free(contents);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+
+    contents[size] = '\0';
+    *length = size;
+    return contents;
+}
+
+void file_contents_init(FileContents *contents)
+{
+    contents->data = NULL;
+    contents->length = 0;
+    contents->mapping = NULL;
+    contents->copy = NULL;
+}
+
+#ifndef _WIN32
+/* Maps the file at path. Returns 0 on success, 1 if it cannot be mapped, -1 on error */
+static int map_file(FileContents *contents, const char *path)
+{
+    struct stat st;
+    void *mapping;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return -1;
+
+    /* pipes cannot be mapped and an empty mapping is invalid */
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* the mapping keeps the file */
+    if (mapping == MAP_FAILED)
+        return 1;
+
+    contents->mapping = mapping;
+    contents->data = mapping;
+    contents->length = (size_t)st.st_size;
+    return 0;
+}
+#endif
+
+int file_contents_load(FileContents *contents, const char *path)
+{
+    file_contents_init(contents);
+
+#ifndef _WIN32
+    {
+        int mapped = map_file(contents, path);
+        if (mapped <= 0)
+            return mapped;
+    }
+#endif
+
+    contents->copy = read_file_contents(path, &contents->length);
+    if (!contents->copy)
+        return -1;
+    contents->data = contents->copy;
+    return 0;
+}
+
+void file_contents_release(FileContents *contents)
+{
+#ifndef _WIN32
+    if (contents->mapping)
+        munmap(contents->mapping, contents->length);
+#endif
+    free(contents->copy);
+    file_contents_init(contents);
+}
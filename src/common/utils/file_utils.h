@@ -11,14 +11,33 @@
 /* Returns 0 on success, negative on error */
 int extract_basename_no_ext(const char *input_path, char *output_basename, size_t max_len);
 
-/* Creates an output path in the output directory based on the base filename only */
-/* output_basename: the filename without directories or extension (e.g., "prog1") */
-/* output_path: output string for the full path (e.g., "output/prog1.am") */
-/* max_len: size of the output_path string */
-void make_output_path(const char *output_basename, char *output_path, size_t max_len);
-
 /* Ensures that a directory named directory_path exists, creates it if it does not */
 /* Returns 0 on success, negative on error */
 int ensure_directory_exists(const char *directory_path);
 
+/* Reads a whole file into a newly allocated, '\0' terminated buffer (caller frees) */
+/* Stores the number of bytes read in *length. Returns NULL on error */
+char *read_file_contents(const char *path, size_t *length);
+
+/* The contents of a file, memory-mapped when possible and read into memory otherwise */
+typedef struct
+{
+    const char *data; /* not necessarily '\0' terminated */
+    size_t length;
+    void *mapping;    /* the mapped pages, NULL when the file was read */
+    char *copy;       /* the read contents, NULL when the file is mapped */
+} FileContents;
+
+void file_contents_init(FileContents *contents);
+
+/*
+ * Maps the regular file at path read-only, or reads it when it cannot be
+ * mapped (pipes, empty files, platforms without mmap).
+ * Returns 0 on success, -1 on error.
+ */
+int file_contents_load(FileContents *contents, const char *path);
+
+/* Unmaps or frees the contents, leaving them empty */
+void file_contents_release(FileContents *contents);
+
 #endif /* FILE_UTILS_H */
\ No newline at end of file
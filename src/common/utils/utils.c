@@ -1,5 +1,6 @@
 #include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
 
 int is_valid_number(char *s)
 {
@@ -49,10 +50,13 @@ char *my_strdup(const char *s)
     return new_str;
 }
 
-char *trim_whitespace(char *str)
+/**
+ * Copies str into the caller's buffer without spaces, tabs and newlines.
+ * The buffer is owned by the caller, so concurrent assemblies never share it.
+ */
+char *trim_whitespace(const char *str, char *trimmed, size_t size)
 {
-    static char trimmed[1024];
-    int i = 0, j = 0;
+    size_t i = 0, j = 0;
     if (!str)
     {
         trimmed[0] = '\0';
@@ -60,7 +64,7 @@ char *trim_whitespace(char *str)
     }
     while (str[i] == ' ' || str[i] == '\t' || str[i] == '\n')
         i++;
-    for (; str[i] != '\0'; i++)
+    for (; str[i] != '\0' && j < size - 1; i++)
     {
         if (str[i] != ' ' && str[i] != '\t' && str[i] != '\n')
             trimmed[j++] = str[i];
@@ -1,7 +1,11 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stddef.h>
+
 int is_valid_number(char *s);
 int is_valid_num_char(char c);
+char *my_strdup(const char *s);
+char *trim_whitespace(const char *str, char *trimmed, size_t size);
 
 #endif
\ No newline at end of file
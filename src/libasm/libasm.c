@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include <string.h>
+#include "libasm.h"
+#include "../assembler/assembler.h"
+
+/*-----------------------------------------------------------
+    libasm
+    Thin wrapper that runs the assembler stages on a private
+    context and moves the in-memory outputs to the caller
+------------------------------------------------------------*/
+
+/* Name used for the in-memory source wherever a file name is expected */
+#define BUFFER_INPUT_NAME "<buffer>"
+
+static void clear_result(AsmResult *result)
+{
+    memset(result, 0, sizeof(*result));
+}
+
+/* Copies the diagnostics of status_info into result. Returns 0 on success */
+static int copy_diagnostics(AsmResult *result, const StatusInfo *status_info)
+{
+    int count = status_info->error_count + status_info->warning_count;
+    int i;
+
+    result->error_count = status_info->error_count;
+    result->warning_count = status_info->warning_count;
+    if (count == 0)
+        return 0;
+
+    result->diagnostics = malloc(sizeof(AsmDiagnostic) * count);
+    if (!result->diagnostics)
+        return -1;
+
+    for (i = 0; i < count; i++)
+    {
+        result->diagnostics[i].line = status_info->error_log[i].line_number;
+        result->diagnostics[i].code = status_info->error_log[i].code;
+        result->diagnostics[i].is_error = status_info->error_log[i].sevirity == SEV_ERROR;
+        result->diagnostics[i].message = status_info->error_log[i].message;
+    }
+    result->diagnostic_count = count;
+    return 0;
+}
+
+AsmStatus asm_assemble_buffer(const char *src, size_t len, AsmResult *out)
+{
+    AssemblerContext *ctx;
+    AssemblyResult result;
+
+    if (!out)
+        return ASM_FAILED_MEMORY;
+    clear_result(out);
+
+    /* defaults never write the .am file, so nothing touches the disk */
+    ctx = context_create(NULL);
+    if (!src || !ctx || context_set_input(ctx, BUFFER_INPUT_NAME) != 0)
+    {
+        context_destroy(ctx);
+        out->status = ASM_FAILED_MEMORY;
+        return out->status;
+    }
+    ctx->status_info->echo = 0;
+    context_set_source(ctx, src, len);
+
+    result = assemble_source(ctx);
+    switch (result)
+    {
+    case ASSEMBLY_OK:
+        out->status = ASM_OK;
+        break;
+    case ASSEMBLY_FAILED_PRE_ASSEMBLER:
+        out->status = ASM_FAILED_PRE_ASSEMBLER;
+        break;
+    case ASSEMBLY_FAILED_FIRST_PASS:
+        out->status = ASM_FAILED_FIRST_PASS;
+        break;
+    case ASSEMBLY_FAILED_SECOND_PASS:
+        out->status = ASM_FAILED_SECOND_PASS;
+        break;
+    default:
+        /* with the source in memory, the only I/O left to fail is allocation */
+        out->status = ASM_FAILED_MEMORY;
+        break;
+    }
+
+    /* a stage that ran out of memory may have failed with an incomplete log */
+    if (ctx->status_info->is_out_of_memory)
+        out->status = ASM_FAILED_MEMORY;
+
+    if (copy_diagnostics(out, ctx->status_info) != 0)
+        out->status = ASM_FAILED_MEMORY;
+
+    if (out->status == ASM_OK)
+    {
+        out->object = text_buffer_detach(&ctx->object_file, &out->object_size);
+        if (ctx->entries_file.size > 0)
+            out->entries = text_buffer_detach(&ctx->entries_file, &out->entries_size);
+        if (ctx->externals_file.size > 0)
+            out->externals = text_buffer_detach(&ctx->externals_file, &out->externals_size);
+    }
+
+    context_destroy(ctx);
+    return out->status;
+}
+
+void asm_result_free(AsmResult *result)
+{
+    if (!result)
+        return;
+
+    free(result->object);
+    free(result->entries);
+    free(result->externals);
+    free(result->diagnostics);
+    clear_result(result);
+}
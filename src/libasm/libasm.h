@@ -0,0 +1,62 @@
+#ifndef LIBASM_H
+#define LIBASM_H
+
+#include <stddef.h>
+
+/*-----------------------------------------------------------
+    libasm - the assembler as a library
+    Assembles a source held in memory and returns the generated
+    files in memory; nothing is read from or written to disk.
+    Every call is independent, so calls may run concurrently
+    from different threads.
+------------------------------------------------------------*/
+
+/* Outcome of asm_assemble_buffer */
+typedef enum
+{
+    ASM_OK = 0,
+    ASM_FAILED_MEMORY,        /* out of memory, or invalid arguments */
+    ASM_FAILED_PRE_ASSEMBLER, /* errors in macro expansion */
+    ASM_FAILED_FIRST_PASS,    /* errors while parsing and encoding */
+    ASM_FAILED_SECOND_PASS    /* errors while resolving labels */
+} AsmStatus;
+
+/* One error or warning, in the order they were found */
+typedef struct
+{
+    int line;            /* line of the source buffer, starting at 1 */
+    int code;            /* numeric error code, as listed in the README */
+    int is_error;        /* 0 for warnings */
+    const char *message; /* static string, never freed */
+} AsmDiagnostic;
+
+/* Everything produced by one assembly; release with asm_result_free */
+typedef struct
+{
+    AsmStatus status;
+
+    /* generated files, '\0' terminated; NULL when not produced */
+    char *object;    /* .ob contents (only when status is ASM_OK) */
+    size_t object_size;
+    char *entries;   /* .ent contents, NULL when there are no entries */
+    size_t entries_size;
+    char *externals; /* .ext contents, NULL when no extern is referenced */
+    size_t externals_size;
+
+    AsmDiagnostic *diagnostics;
+    int diagnostic_count;
+    int error_count;
+    int warning_count;
+} AsmResult;
+
+/*
+ * Assembles len bytes of source text (no '\0' terminator needed).
+ * Fills *out, which must be released with asm_result_free even on failure.
+ * Returns out->status.
+ */
+AsmStatus asm_assemble_buffer(const char *src, size_t len, AsmResult *out);
+
+/* Frees everything held by result and leaves it empty */
+void asm_result_free(AsmResult *result);
+
+#endif
@@ -1,309 +1,162 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include "common/errors/errors.h"
-#include "stg_00_preprocessor/preprocessor.h"
-#include "stg_01_first_pass/first_pass.h"
+#include "common/utils/file_utils.h"
+#include "assembler/context.h"
+#include "assembler/batch.h"
+#include "server/server.h"
+#include "common/log/log.h"
 
-void generate_expanded_filename(char *dest, size_t dest_size, const char *basename);
-void generate_output_files(EncodedList *encoded_list, Table *symbol_table);
-
-int main(int argc, char *argv[])
+static void print_usage(const char *program_name)
 {
-    /* Check if input file was provided */
-    if (argc < 2)
-    {
-        /* Print usage message and exit with error code */
-        fprintf(stderr, "Usage: %s <input file>\n", argv[0]);
-        return 1;
-    }
-
-    /* Get pointer to input filename from command-line argument */
-    const char *input_filename = argv[1];
-
-    StatusInfo *status_info = malloc(sizeof(StatusInfo));
-    status_info->error_log = malloc(sizeof(ErrorInfo) * 10);
-    status_info->capacity = 10;
-    status_info->warning_count = 0;
-
-    const char *basename = strrchr(input_filename, '/');
-    if (basename != NULL)
-        basename++; /* Skip the '/' */
-    else
-        basename = input_filename;
-
-    char expanded_filename[1024];
-    generate_expanded_filename(expanded_filename, sizeof(expanded_filename), basename);
-
-    /* Run the pre-assembler on the original source file */
-    run_pre_assembler(input_filename, status_info);
-
-    print_errors(status_info);
-    if (status_info->error_count > 0)
-    {
-        printf("Did not pass preprocessor stage\n");
-        return 0;
-    }
+    fprintf(stderr, "Usage: %s [-j <jobs>] [-o <output dir>] [--am] [--binary] [--pipeline] [--cache <dir>]\n"
+                    "          [-q | --quiet | -v[v[v]]] [--log <categories>] <input file> [<input file> ...]\n",
+            program_name);
+    fprintf(stderr, "       %s [--pipeline] [-v[v[v]]] --serve <socket path>\n", program_name);
+}
 
-    /* Run the first pass on the preprocessed (".am") file */
-    ASTNode *ast_head = NULL;
-    Table *symbol_table = table_create();
-    EncodedList *encoded_list = malloc(sizeof(EncodedList));
-    if (!encoded_list)
-    {
-        fprintf(stderr, "Memory allocation failed\n");
-        return 1;
-    }
+/*
+ * Returns the value of a short option given either as "-xVALUE" or as "-x VALUE".
+ * Advances *i past a separate value argument. Returns NULL if the value is missing.
+ */
+static const char *option_value(int argc, char *argv[], int *i)
+{
+    if (argv[*i][2] != '\0')
+        return argv[*i] + 2;
+    if (*i + 1 < argc)
+        return argv[++(*i)];
+    return NULL;
+}
 
-    /* Initialize */
-    encoded_list->size = 0;
-    encoded_list->head = NULL;
-    encoded_list->tail = NULL;
+int main(int argc, char *argv[])
+{
+    AssemblerOptions options;
+    const char *socket_path = NULL;
+    int log_level = LOG_DEFAULT_LEVEL;
+    int worker_count = 1;
+    int input_count = 0;
+    int i;
 
-    int IC = 100;
-    run_first_pass(expanded_filename, symbol_table, &ast_head, &IC, encoded_list, status_info);
+    init_assembler_options(&options);
 
-    /* update data memory locations, count words */
-    TableNode *current = symbol_table->head;
-    SymbolInfo *curr_info = (SymbolInfo *)current;
-    int ICF = IC;
-    int j = 1;
-    int instruction_word_count = 0;
-    int data_word_count = 0;
-    while (current && current->next)
+    /* Collect options; every other argument is an input file (compacted in place) */
+    for (i = 1; i < argc; i++)
     {
-        void *data_ptr = current->data;
-        curr_info = (SymbolInfo *)data_ptr;
-        strcpy(((SymbolInfo *)current->data)->name, current->key);
-        j++;
-        if (curr_info->type == SYMBOL_DATA)
+        if (strncmp(argv[i], "-j", 2) == 0)
         {
-            printf("%s\n", current->key);
-            curr_info->address += ICF;
-            printf("--> moving data symbol to data image\nnew address: %d\n\n", curr_info->address);
-        }
-
-        current = current->next;
-    }
-    {
-        EncodedLine *el = encoded_list->head;
-        while (el)
-        {
-            ASTNode *node = el->ast_node;
-            if (node->type == INSTRUCTION_STATEMENT)
+            const char *value = option_value(argc, argv, &i);
+            worker_count = value ? atoi(value) : 0;
+            if (worker_count < 1)
             {
-                instruction_word_count += el->words_count;
+                fprintf(stderr, "Invalid number of jobs\n");
+                print_usage(argv[0]);
+                return 1;
             }
-            else if (node->type == DIRECTIVE_STATEMENT)
+        }
+        else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quiet") == 0)
+        {
+            log_level = LOG_LEVEL_ERROR;
+        }
+        else if (argv[i][0] == '-' && argv[i][1] == 'v' && strspn(argv[i] + 1, "v") == strlen(argv[i] + 1))
+        {
+            /* every 'v' raises the level by one: -v info, -vv debug, -vvv trace */
+            log_level += (int)strlen(argv[i] + 1);
+            if (log_level > LOG_LEVEL_TRACE)
+                log_level = LOG_LEVEL_TRACE;
+        }
+        else if (strcmp(argv[i], "--log") == 0)
+        {
+            if (i + 1 >= argc || log_set_categories(argv[i + 1]) != 0)
             {
-                int data_size = node->content.directive.params.data.size;
-                data_word_count += data_size;
+                fprintf(stderr, "Invalid log categories (general, preprocessor, first_pass, second_pass, encoding, output)\n");
+                print_usage(argv[0]);
+                return 1;
             }
-            el = el->next;
+            i++;
         }
-    }
-
-    /* CHECK ERROR LOG */
-    if (status_info->error_count > 0)
-    {
-        int i;
-
-        printf("Error count: %d\n", status_info->error_count);
-        printf("Warning count: %d\n", status_info->warning_count);
-        printf("Did not pass first_pass stage\n");
-
-        for (i = 0; i < status_info->error_count; i++)
+        else if (strcmp(argv[i], "--am") == 0)
+        {
+            options.write_expanded_file = 1;
+        }
+        else if (strcmp(argv[i], "--binary") == 0)
+        {
+            options.write_binary_object = 1;
+        }
+        else if (strcmp(argv[i], "--pipeline") == 0)
         {
-            if (status_info->error_log[i].sevirity == SEV_ERROR)
+            options.pipeline = 1;
+        }
+        else if (strcmp(argv[i], "--cache") == 0)
+        {
+            if (i + 1 >= argc || argv[i + 1][0] == '\0')
             {
-                printf("\033[1;31mLine: %d: %s\033[0m\n",
-                       status_info->error_log[i].line_number,
-                       status_info->error_log[i].message); /* Red */
+                fprintf(stderr, "Missing cache directory\n");
+                print_usage(argv[0]);
+                return 1;
             }
-            else if (status_info->error_log[i].sevirity == SEV_WARNING)
+            options.cache_dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--serve") == 0)
+        {
+            if (i + 1 >= argc || argv[i + 1][0] == '\0')
             {
-                printf("\033[1;33mLine: %d: %s\033[0m\n",
-                       status_info->error_log[i].line_number,
-                       status_info->error_log[i].message); /* Yellow */
+                fprintf(stderr, "Missing socket path\n");
+                print_usage(argv[0]);
+                return 1;
             }
-            else
+            socket_path = argv[++i];
+        }
+        else if (strncmp(argv[i], "-o", 2) == 0)
+        {
+            options.output_dir = option_value(argc, argv, &i);
+            if (!options.output_dir || options.output_dir[0] == '\0')
             {
-                printf("Line: %d: %s\n",
-                       status_info->error_log[i].line_number,
-                       status_info->error_log[i].message);
+                fprintf(stderr, "Missing output directory\n");
+                print_usage(argv[0]);
+                return 1;
             }
         }
-        return 0;
+        else
+        {
+            argv[1 + input_count++] = argv[i];
+        }
     }
 
-    printf("\033[1;32m------------ Starting 2nd pass ------------\033[0m\n\n");
-    run_second_pass(symbol_table, &ast_head, encoded_list, status_info);
+    /* Set once, before any worker thread starts */
+    log_set_level((LogLevel)log_level);
 
-    /* CHECK ERROR LOG */
-    if (status_info->error_count > 0)
+    /* Daemon mode: sources arrive over the socket, nothing is written to disk */
+    if (socket_path)
     {
-        int i;
-
-        printf("Error count: %d\n", status_info->error_count);
-        printf("Warning count: %d\n", status_info->warning_count);
-        printf("Did not pass first_pass stage\n");
-
-        for (i = 0; i < status_info->error_count; i++)
+        if (input_count > 0)
         {
-            if (status_info->error_log[i].sevirity == SEV_ERROR)
-            {
-                printf("\033[1;31mLine: %d: %s\033[0m\n",
-                       status_info->error_log[i].line_number,
-                       status_info->error_log[i].message); /* Red */
-            }
-            else if (status_info->error_log[i].sevirity == SEV_WARNING)
-            {
-                printf("\033[1;33mLine: %d: %s\033[0m\n",
-                       status_info->error_log[i].line_number,
-                       status_info->error_log[i].message); /* Yellow */
-            }
-            else
-            {
-                printf("Line: %d: %s\n",
-                       status_info->error_log[i].line_number,
-                       status_info->error_log[i].message);
-            }
+            fprintf(stderr, "--serve does not take input files\n");
+            print_usage(argv[0]);
+            return 1;
         }
-        return 0;
+        return run_server(socket_path, &options);
     }
 
-    generate_output_files(encoded_list, symbol_table);
-
-    return 0;
-}
-
-void generate_expanded_filename(char *dest, size_t dest_size, const char *basename)
-{
-    snprintf(dest, dest_size, "output/%.*s.am",
-             (int)(strrchr(basename, '.') ? strrchr(basename, '.') - basename : strlen(basename)),
-             basename);
-}
-
-void generate_output_files(EncodedList *encoded_list, Table *symbol_table)
-{
-    /* Open output .ob (always needed) */
-    FILE *fp = fopen("output/prog1.ob", "w");
-    if (!fp) {
-        fprintf(stderr, "Error opening output/prog1.ob\n");
-        return;
+    /* Check if at least one input file was provided */
+    if (input_count == 0)
+    {
+        /* Print usage message and exit with error code */
+        print_usage(argv[0]);
+        return 1;
     }
 
-    /* ent/ext files will be opened conditionally */
-    FILE *ent_file = NULL;
-    FILE *ext_file = NULL;
-
-    /* ---- Reserve header: fixed width so overwrite won't shift lines ---- */
-    /* Keep the SAME format for the final overwrite */
-    fprintf(fp, "%10d\t%10d\n", 0, 0);
-
-    int instruction_word_count = 0;
-    int data_word_count = 0;
-
-    /* output .ob and log externs using address counter */
-    int address = 100;
-    EncodedLine *curr_encoded_line = encoded_list->head;
-    while (curr_encoded_line)
+    /* The output directory is shared by all inputs, check it only once */
+    if (ensure_directory_exists(options.output_dir) != 0)
     {
-        ASTNode *node = curr_encoded_line->ast_node;
-        char base4_add[5];
-        char base4_code[5];
-
-        if (node->type == INSTRUCTION_STATEMENT)
-        {
-            int i;
-            for (i = 0; i < curr_encoded_line->words_count; i++)
-            {
-                addr_to_base4(address, base4_add);
-                int code_to_write = bincode_to_int(curr_encoded_line->words[i]);
-                bincode_to_base4(code_to_write, base4_code);
-                fprintf(fp, "%03s\t%s\n", base4_add, base4_code);
-
-                /* If this word is an extern reference, log it (open .ext lazily) */
-                if (curr_encoded_line->is_waiting_words[i] == 2)
-                {
-                    if (!ext_file)
-                    {
-                        ext_file = fopen("output/prog1.ext", "w");
-                        if (!ext_file) {
-                            fprintf(stderr, "Error opening output/prog1.ext\n");
-                            /* If we cannot open .ext, just skip writing externs */
-                        }
-                    }
-
-                    if (ext_file)
-                    {
-                        char *symbol_name = NULL;
-                        if (i == 0)
-                            symbol_name = node->content.instruction.src_op.value.label;
-                        else
-                            symbol_name = node->content.instruction.dest_op.value.label;
-
-                        fprintf(ext_file, "%s\t%s\n", symbol_name, base4_add);
-                    }
-                }
-
-                instruction_word_count++;
-                address++;
-            }
-        }
-        else if (node->type == DIRECTIVE_STATEMENT)
-        {
-            int data_size = node->content.directive.params.data.size;
-            int i;
-            for (i = 0; i < data_size; i++)
-            {
-                addr_to_base4(address, base4_add);
-                int code_to_write = bincode_to_signed(curr_encoded_line->data_words[i]);
-                bincode_to_signed_base4(code_to_write, base4_code);
-                fprintf(fp, "%s\t%s\n", base4_add, base4_code);
-                data_word_count++;
-                address++;
-            }
-        }
-
-        curr_encoded_line = curr_encoded_line->next;
+        fprintf(stderr, "❌ Failed to create or access '%s/' directory\n", options.output_dir);
+        return 1;
     }
 
-    /* Write .ent only if there are entry labels (open lazily on first one) */
+    if (options.cache_dir && ensure_directory_exists(options.cache_dir) != 0)
     {
-        TableNode *current_node = symbol_table->head;
-        while (current_node)
-        {
-            SymbolInfo *info = (SymbolInfo *)current_node->data;
-            if (info->is_entry == 1)
-            {
-                if (!ent_file)
-                {
-                    ent_file = fopen("output/prog1.ent", "w");
-                    if (!ent_file) {
-                        fprintf(stderr, "Error opening output/prog1.ent\n");
-                        /* If cannot open, don't attempt further writes */
-                        break;
-                    }
-                }
-
-                if (ent_file)
-                {
-                    char base4_add[5];
-                    addr_to_base4(info->address, base4_add);
-                    fprintf(ent_file, "%s\t%s\n", info->name, base4_add);
-                }
-            }
-            current_node = current_node->next;
-        }
+        fprintf(stderr, "❌ Failed to create or access cache directory '%s'\n", options.cache_dir);
+        return 1;
     }
 
-    /* ---- Overwrite header in place (no shifting) ---- */
-    fflush(fp);                /* ensure body is on disk before seeking */
-    fseek(fp, 0, SEEK_SET);   /* go back to file start */
-    fprintf(fp, "%10d\t%10d\n", instruction_word_count, data_word_count);
-
-    fclose(fp);
-    if (ent_file) fclose(ent_file);
-    if (ext_file) fclose(ext_file);
+    return run_batch(argv + 1, input_count, worker_count, &options);
 }
@@ -0,0 +1,287 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+#include "../assembler/assembler.h"
+
+/*-----------------------------------------------------------
+    Assembler daemon
+    Keeps one warm context and assembles source buffers sent
+    over a Unix domain socket; nothing is written to disk
+------------------------------------------------------------*/
+
+#define MAX_REQUEST_LINE 64
+
+/* Per-server state reused by every request */
+typedef struct
+{
+    AssemblerContext *ctx;
+    char *source;            /* receive buffer, grown as needed */
+    size_t source_capacity;
+    int is_shutting_down;
+} Server;
+
+static const char *result_name(AssemblyResult result)
+{
+    switch (result)
+    {
+    case ASSEMBLY_OK:
+        return "ok";
+    case ASSEMBLY_FAILED_PRE_ASSEMBLER:
+        return "preprocessor";
+    case ASSEMBLY_FAILED_FIRST_PASS:
+        return "first_pass";
+    case ASSEMBLY_FAILED_SECOND_PASS:
+        return "second_pass";
+    default:
+        return "io";
+    }
+}
+
+/* Writes the response for the assembly that just ran on the server's context */
+static void write_response(FILE *out, const AssemblerContext *ctx, AssemblyResult result)
+{
+    const StatusInfo *status_info = ctx->status_info;
+    int is_ok = result == ASSEMBLY_OK;
+    int i;
+
+    fprintf(out, "status %s errors %d warnings %d object %lu entries %lu externals %lu\n",
+            result_name(result), status_info->error_count, status_info->warning_count,
+            is_ok ? (unsigned long)ctx->object_file.size : 0UL,
+            is_ok ? (unsigned long)ctx->entries_file.size : 0UL,
+            is_ok ? (unsigned long)ctx->externals_file.size : 0UL);
+
+    for (i = 0; i < status_info->error_count + status_info->warning_count; i++)
+    {
+        const ErrorInfo *entry = &status_info->error_log[i];
+        fprintf(out, "%c %d %d %s\n", entry->sevirity == SEV_ERROR ? 'E' : 'W',
+                entry->line_number, (int)entry->code, entry->message);
+    }
+
+    if (is_ok)
+    {
+        fwrite(ctx->object_file.data, 1, ctx->object_file.size, out);
+        if (ctx->entries_file.size > 0)
+            fwrite(ctx->entries_file.data, 1, ctx->entries_file.size, out);
+        if (ctx->externals_file.size > 0)
+            fwrite(ctx->externals_file.data, 1, ctx->externals_file.size, out);
+    }
+    fflush(out);
+}
+
+/* Reads <length> bytes of source and assembles them. Returns 0 on success */
+static int handle_assemble(Server *server, FILE *in, FILE *out, long length)
+{
+    AssemblerContext *ctx = server->ctx;
+    AssemblyResult result;
+
+    if (length < 0 || length > SERVER_MAX_SOURCE)
+    {
+        fprintf(out, "error source too large\n");
+        fflush(out);
+        return -1;
+    }
+
+    if ((size_t)length > server->source_capacity)
+    {
+        char *grown = realloc(server->source, (size_t)length);
+        if (!grown)
+        {
+            fprintf(out, "error out of memory\n");
+            fflush(out);
+            return -1;
+        }
+        server->source = grown;
+        server->source_capacity = (size_t)length;
+    }
+
+    if (length > 0 && fread(server->source, 1, (size_t)length, in) != (size_t)length)
+        return -1;
+
+    context_set_input(ctx, "<socket>");
+    context_set_source(ctx, server->source, (size_t)length);
+    result = assemble_source(ctx);
+    write_response(out, ctx, result);
+
+    /* keep every allocation for the next request */
+    context_reset(ctx);
+    return 0;
+}
+
+/* Serves requests on one connection until the client hangs up */
+static void serve_connection(Server *server, int fd)
+{
+    FILE *in = fdopen(fd, "r");
+    FILE *out;
+    char request[MAX_REQUEST_LINE];
+    long length;
+    int out_fd = dup(fd);
+
+    out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+    if (!in || !out)
+    {
+        if (in)
+            fclose(in);
+        else
+            close(fd);
+        if (out)
+            fclose(out);
+        else if (out_fd >= 0)
+            close(out_fd);
+        return;
+    }
+
+    while (fgets(request, sizeof(request), in) != NULL)
+    {
+        if (sscanf(request, "assemble %ld", &length) == 1)
+        {
+            if (handle_assemble(server, in, out, length) != 0)
+                break;
+        }
+        else if (strcmp(request, "shutdown\n") == 0)
+        {
+            fprintf(out, "ok\n");
+            server->is_shutting_down = 1;
+            break;
+        }
+        else
+        {
+            fprintf(out, "error unknown request\n");
+            fflush(out);
+            break;
+        }
+    }
+
+    fclose(in);
+    fclose(out);
+}
+
+/*
+ * Clears the way for a new socket at socket_path. Only a socket left behind
+ * by a previous server is removed; anything else there is an error.
+ * Returns 0 if the path is free, -1 otherwise.
+ */
+static int remove_stale_socket(const char *socket_path)
+{
+    struct stat info;
+
+    if (lstat(socket_path, &info) != 0)
+    {
+        if (errno == ENOENT)
+            return 0;
+        perror(socket_path);
+        return -1;
+    }
+    if (!S_ISSOCK(info.st_mode))
+    {
+        fprintf(stderr, "❌ Not a socket, refusing to replace: %s\n", socket_path);
+        return -1;
+    }
+    if (unlink(socket_path) != 0)
+    {
+        perror(socket_path);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Creates the listening socket; created receives the socket file's identity.
+ * Returns its descriptor, or -1
+ */
+static int open_listener(const char *socket_path, struct stat *created)
+{
+    struct sockaddr_un address;
+    int fd;
+
+    if (strlen(socket_path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "❌ Socket path too long: %s\n", socket_path);
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    /* a socket left behind by a previous server would make bind fail */
+    if (remove_stale_socket(socket_path) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || lstat(socket_path, created) != 0 ||
+        listen(fd, 8) != 0)
+    {
+        perror(socket_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int run_server(const char *socket_path, const AssemblerOptions *options)
+{
+    Server server;
+    struct stat created, current;
+    int listener;
+
+    server.ctx = context_create(options);
+    server.source = NULL;
+    server.source_capacity = 0;
+    server.is_shutting_down = 0;
+    if (!server.ctx)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    /* diagnostics go back to the client, and nothing is written next to the sources */
+    server.ctx->status_info->echo = 0;
+    server.ctx->options.write_expanded_file = 0;
+
+    listener = open_listener(socket_path, &created);
+    if (listener < 0)
+    {
+        context_destroy(server.ctx);
+        return 1;
+    }
+
+    /* a client hanging up mid-response must not kill the server */
+    signal(SIGPIPE, SIG_IGN);
+    fprintf(stderr, "Serving on %s\n", socket_path);
+
+    while (!server.is_shutting_down)
+    {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0)
+        {
+            perror("accept");
+            continue;
+        }
+        serve_connection(&server, fd);
+    }
+
+    close(listener);
+
+    /* remove the socket only if it is still the one this server created */
+    if (lstat(socket_path, &current) == 0 && S_ISSOCK(current.st_mode) && current.st_dev == created.st_dev &&
+        current.st_ino == created.st_ino)
+        unlink(socket_path);
+    free(server.source);
+    context_destroy(server.ctx);
+    return 0;
+}
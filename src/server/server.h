@@ -0,0 +1,26 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "../assembler/context.h"
+
+/*
+ * Protocol spoken on the socket (one connection may send many requests):
+ *
+ *   request:   "assemble <length>\n" followed by <length> bytes of source
+ *              "shutdown\n" stops the server
+ *
+ *   response:  "status <result> errors <n> warnings <n> object <length> entries <length> externals <length>\n"
+ *              one line per diagnostic: "<E|W> <line> <code> <message>\n"
+ *              then the .ob, .ent and .ext contents, back to back
+ *
+ * <result> is one of ok, io, preprocessor, first_pass, second_pass.
+ * Output lengths are 0 unless the result is ok.
+ */
+
+#define SERVER_MAX_SOURCE (16L * 1024 * 1024) /* largest source accepted in one request */
+
+/* Serves assembly requests on a Unix domain socket at socket_path until shut down */
+/* Returns 0 after a shutdown request, 1 if the socket could not be set up */
+int run_server(const char *socket_path, const AssemblerOptions *options);
+
+#endif
@@ -1,136 +1,140 @@
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include "macro_table.h"
 #include "../common/errors/errors.h"
+#include "../common/log/log.h"
 
-#define MAX_MACRO_NAME_LEN 31
-#define MAX_MACRO_LINES 100
+#define INITIAL_MACRO_LINE_CAPACITY 128
 
-void init_macro_table(MacroTable *table)
+int init_macro_table(MacroTable *table)
 {
+    table->source = NULL;
+    table->first = NULL;
+    table->last = NULL;
     table->count = 0;
+    arena_init(&table->records);
+    table->lines = NULL;
+    table->line_count = 0;
+    table->line_capacity = 0;
+    table->index = table_create();
+    return table->index ? 0 : -1;
 }
 
-int add_macro(MacroTable *table, const char *name, char lines[MAX_LINES_PER_MACRO][MAX_LINE_LEN], int line_count)
+void reset_macro_table(MacroTable *table, const char *source)
 {
-    printf("Adding macro: %s with %d lines\n", name, line_count);
+    table->source = source;
+    table->first = NULL;
+    table->last = NULL;
+    table->count = 0;
+    table_clear(table->index, NULL);
+    arena_reset(&table->records);
+    table->line_count = 0;
+}
 
-    int i;
-    if (table->count >= MAX_MACROS)
+int add_macro_line(MacroTable *table, const IndexedLine *line, const Tokens *tokens)
+{
+    MacroLine *body_line;
+    const Tokens *copy;
+
+    if (table->line_count == table->line_capacity)
     {
-        fprintf(stderr, "Error: Macro table full\n");
-        return 0;
+        int capacity = table->line_capacity ? table->line_capacity * 2 : INITIAL_MACRO_LINE_CAPACITY;
+        MacroLine *lines = realloc(table->lines, sizeof(MacroLine) * capacity);
+        if (!lines)
+            return 0;
+        table->lines = lines;
+        table->line_capacity = capacity;
     }
 
-    Macro *macro = &table->macros[table->count];
-    strncpy(macro->name, name, MAX_MACRO_NAME_LEN - 1);
-    macro->name[MAX_MACRO_NAME_LEN - 1] = '\0';
+    /* the copy lives in the arena: the first pass may still read it while more lines are added */
+    copy = tokens_snapshot(&table->records, tokens, table->source + line->offset);
+    if (!copy)
+        return 0;
+
+    body_line = &table->lines[table->line_count++];
+    body_line->offset = line->offset;
+    body_line->length = line->length;
+    body_line->kind = line->kind;
+    body_line->tokens = copy;
+    return 1; /*Success*/
+}
+
+int add_macro(MacroTable *table, size_t name_offset, size_t name_length, int first_line, int line_count)
+{
+    Macro *macro = arena_alloc(&table->records, sizeof(Macro));
+    char *name = arena_strndup(&table->records, table->source + name_offset, name_length);
+
+    if (!macro || !name)
+        return 0;
+
+    LOG_DEBUG(LOG_PREPROCESSOR, ("Adding macro: %s with %d lines\n", name, line_count));
+
+    macro->name = name;
+    macro->first_line = first_line;
     macro->line_count = line_count;
+    macro->next = NULL;
 
-    for (i = 0; i < line_count && i < MAX_MACRO_LINES; ++i)
-    {
-        strncpy(macro->lines[i], lines[i], MAX_LINE_LEN - 1);
-        macro->lines[i][MAX_LINE_LEN - 1] = '\0';
-    }
+    /* a repeated name stays bound to its first definition */
+    if (!table_lookup(table->index, name) && !table_insert(table->index, name, macro))
+        return 0;
 
+    if (table->last)
+        table->last->next = macro;
+    else
+        table->first = macro;
+    table->last = macro;
     table->count++;
     return 1;
 }
 
-int add_macro_line(MacroTable *table, const char *line)
+const Macro *get_macro(const MacroTable *table, const char *name)
 {
-    if (table->count == 0)
-        return 0; /*No macro to add to*/
-
-    Macro *current = &table->macros[table->count - 1];
-    if (current->line_count >= MAX_LINES_PER_MACRO)
-        return 0; /*Too many lines*/
-
-    strncpy(current->lines[current->line_count], line, MAX_LINE_LEN - 1);
-    current->lines[current->line_count][MAX_LINE_LEN - 1] = '\0';
-    current->line_count++;
-    return 1; /*Success*/
+    return table_lookup(table->index, name);
 }
 
-const int get_macro_idx(const MacroTable *table, const char *name)
+const char *get_macro_line(const MacroTable *table, const Macro *macro, int idx, size_t *length)
 {
-    int i;
-    for (i = 0; i < table->count; i++)
-    {
-        printf("\t🔍 🔍comparing %s with: %s\n", name, table->macros[i].name);
-
-        if (strcmp(table->macros[i].name, name) == 0)
-        {
-            if (table->macros[i].line_count == 0)
-            {
-                fprintf(stderr, "⚠️  Warning: Macro '%s' has no lines\n", table->macros[i].name);
-            }
-            return i;
-        }
-    }
-    return -1;
+    const MacroLine *line = &table->lines[macro->first_line + idx];
+    *length = line->length;
+    return table->source + line->offset;
 }
 
-const Macro *get_macro(const MacroTable *table, const char *name)
+const MacroLine *get_macro_body_line(const MacroTable *table, const Macro *macro, int idx)
 {
-    int i;
-    for (i = 0; i < table->count; i++)
-    {
-        /*
-        printf("\t🔍 🔍comparing %s with: %s\n", name, table->macros[i].name);
-            */
-        if (strcmp(table->macros[i].name, name) == 0)
-        {
-            if (table->macros[i].line_count == 0)
-            {
-                /*
-                fprintf(stderr, "⚠️  Warning: Macro '%s' has no lines\n", table->macros[i].name);
-                */
-            }
-            return &table->macros[i];
-        }
-    }
-    return NULL;
+    return &table->lines[macro->first_line + idx];
 }
 
-void expand_macro(MacroTable *table, const char *name, FILE *output)
+void print_macro_table(const MacroTable *table)
 {
-    int i, j;
-    for (i = 0; i < table->count; ++i)
+    const Macro *macro;
+    int j;
+    log_printf("\n📦 Macro Table:\n");
+    for (macro = table->first; macro; macro = macro->next)
     {
-        if (strcmp(table->macros[i].name, name) == 0)
+        if (macro->name[0] == '\0')
+            continue;
+
+        log_printf("Macro: %s\n", macro->name);
+        for (j = 0; j < macro->line_count; ++j)
         {
-            if (table->macros[i].line_count == 0)
-            {
-                /*
-                printf("🔵 Macro '%s' is empty, expanding to nothing.\n", name);
-                */
-                return;
-            }
-
-            for (j = 0; j < table->macros[i].line_count; ++j)
-            {
-                /*
-                printf("📝 Writing macro line to output: %s", table->macros[i].lines[j]);
-                */
-                fputs(table->macros[i].lines[j], output);
-            }
-            return;
+            size_t length;
+            const char *line = get_macro_line(table, macro, j, &length);
+            log_printf("  Line %d: %.*s", j + 1, (int)length, line);
         }
+        if (macro->line_count == 0)
+            log_printf("  (empty)\n");
     }
-    fprintf(stderr, "Warning: Macro '%s' not found\n", name);
 }
 
-void print_macro_table(const MacroTable *table)
+void free_macro_table(MacroTable *table)
 {
-    int i, j;
-    printf("Macro Table:\n");
-    for (i = 0; i < table->count; ++i)
-    {
-        printf("Macro: %s\n", table->macros[i].name);
-        for (j = 0; j < table->macros[i].line_count; ++j)
-        {
-            printf("  Line %d: %s", j + 1, table->macros[i].lines[j]);
-        }
-    }
-}
\ No newline at end of file
+    if (table->index)
+        table_destroy(table->index, NULL);
+    table->index = NULL;
+    arena_free(&table->records);
+    free(table->lines);
+    table->lines = NULL;
+    table->line_count = 0;
+    table->line_capacity = 0;
+}
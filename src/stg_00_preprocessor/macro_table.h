@@ -1,41 +1,79 @@
 #ifndef MACRO_TABLE_H
 #define MACRO_TABLE_H
 
-#define MAX_MACROS 100
-#define MAX_MACRO_NAME 31
-#define MAX_LINES_PER_MACRO 100
-#define MAX_LINE_LEN 82
-
+#include <stddef.h>
+#include "../common/arena/arena.h"
+#include "../common/table/table.h"
+#include "../common/tokenizer/tokenizer.h"
+#include "../common/lines/line_index.h"
 
+/* A body line: a span of the source text the macros were read from, and its tokens */
 typedef struct
 {
-    char name[MAX_MACRO_NAME];
-    char lines[MAX_LINES_PER_MACRO][MAX_LINE_LEN];
+    size_t offset;
+    size_t length;
+    LineKind kind;
+    const Tokens *tokens; /* tokenized once, replayed at every call */
+} MacroLine;
+
+typedef struct Macro
+{
+    const char *name;
+    int first_line; /* index of the first body line in MacroTable.lines */
     int line_count;
+    struct Macro *next; /* next macro in definition order */
 } Macro;
 
+/*
+ * Macros of one source file. Body lines are not copied: they are spans of
+ * the source text, which outlives the table. The bodies of all macros share
+ * one growable line array, so there is no limit on the number of macros or
+ * on their length. Names are found through a hash index. Each body line
+ * keeps its tokens, so an expansion hands the first pass ready-made tokens
+ * instead of text to lex again.
+ */
 typedef struct
 {
-    Macro macros[MAX_MACROS];
+    const char *source; /* text every span refers to */
+    Macro *first;       /* macros in definition order */
+    Macro *last;
     int count;
+    Table *index;       /* name -> Macro, first definition wins */
+    Arena records;      /* Macro records, their names and body tokens */
+    MacroLine *lines;   /* body lines, macro after macro */
+    int line_count;
+    int line_capacity;
 } MacroTable;
 
-/* Initialize macro table */
-void init_macro_table(MacroTable *table);
+/* Initialize an empty macro table. Returns 0 on success, -1 if out of memory */
+int init_macro_table(MacroTable *table);
+
+/* Forgets every macro, keeping the memory; spans now refer to source */
+void reset_macro_table(MacroTable *table, const char *source);
 
-/* Add a new macro by name. Returns 1 on success, 0 if full, -1 if duplicate */
-int add_macro(MacroTable *table, const char *name, char lines[MAX_LINES_PER_MACRO][MAX_LINE_LEN], int line_count);
+/*
+ * Add a body line of the macro being defined, with the tokens it was split
+ * into (copied). Returns 1 on success, 0 if out of memory.
+ */
+int add_macro_line(MacroTable *table, const IndexedLine *line, const Tokens *tokens);
 
-/* Add a line to the most recently added macro. Returns 1 on success, 0 on overflow */
-int add_macro_line(MacroTable *table, const char *line);
+/*
+ * Add a macro whose body is the line_count lines added since first_line.
+ * Returns 1 on success, 0 if out of memory.
+ */
+int add_macro(MacroTable *table, size_t name_offset, size_t name_length, int first_line, int line_count);
 
-/* Get a pointer to a macro by name, or NULL if not found */
+/* Get a pointer to a macro by name with one hash probe, or NULL if not found */
 const Macro *get_macro(const MacroTable *table, const char *name);
 
-const int get_macro_idx(const MacroTable *table, const char *name);
+/* Text of body line idx of macro (not '\0' terminated); stores its length in length */
+const char *get_macro_line(const MacroTable *table, const Macro *macro, int idx, size_t *length);
 
-void expand_macro(MacroTable *table, const char *name, FILE *output);
+/* Body line idx of macro; its tokens stay valid until the table is reset */
+const MacroLine *get_macro_body_line(const MacroTable *table, const Macro *macro, int idx);
 
 void print_macro_table(const MacroTable *table);
 
+void free_macro_table(MacroTable *table);
+
 #endif
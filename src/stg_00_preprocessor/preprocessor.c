@@ -5,23 +5,16 @@
 #include "preprocessor.h"
 #include "macro_table.h"
 #include "../common/tokenizer/tokenizer.h"
+#include "../common/keywords/keywords.h"
 #include "../common/utils/file_utils.h"
 #include "../common/errors/errors.h"
+#include "../common/log/log.h"
 
 /*-----------------------------------------------------------
     Macro expansion pre-assembler module
     Processes input file, expands macros, and writes output
 ------------------------------------------------------------*/
 
-/*-------------------------
-    Constants and Globals
---------------------------*/
-
-#define MAX_MACRO_LINES 100
-
-/* Used to store the macro currently found (optional global) */
-const Macro *CURR_MACRO = NULL;
-
 /*-------------------------
     Internal States
 --------------------------*/
@@ -43,13 +36,15 @@ typedef enum
 /* Returns 1 if token is 'mcro' */
 int is_macro_start(const char *token)
 {
-    return strncmp(token, "mcro", 4) == 0;
+    const Keyword *keyword = keyword_lookup(token);
+    return keyword && keyword->kind == KEYWORD_MACRO_START;
 }
 
 /* Returns 1 if token is 'mcroend' */
 int is_macro_end(const char *token)
 {
-    return strncmp(token, "mcroend", 7) == 0;
+    const Keyword *keyword = keyword_lookup(token);
+    return keyword && keyword->kind == KEYWORD_MACRO_END;
 }
 
 /* Returns 1 if token is a comment line */
@@ -59,181 +54,218 @@ int is_comment(const char *token)
            (token[0] == '\r' && token[1] == '\n');
 }
 
-/* Checks if macro exists in table and sets CURR_MACRO */
-int macro_exists(const MacroTable *table, const char *name)
-{
-    CURR_MACRO = get_macro(table, name);
-    return (CURR_MACRO != NULL);
-}
-
 /*-------------------------
     Main Pre-Assembler API
 --------------------------*/
 
-int run_pre_assembler(const char *input_path, StatusInfo *status_info)
+/*
+ * Hands len characters of line to the first pass, with what is known about
+ * it. Returns 0 on success, -1 if out of memory.
+ */
+static int emit_line_span(AssemblerContext *ctx, const char *line, size_t len, const LineInfo *info)
 {
-    FILE *input = NULL, *output = NULL;
-    char line[MAX_LINE_LEN];
-    char macro_name[MAX_LINE_LEN];
-    char macro_lines[MAX_LINES_PER_MACRO][MAX_LINE_LEN];
-    int macro_line_count = 0;
-    int line_number = 1;
+    if (ctx->line_ring)
+    {
+        line_ring_push_span(ctx->line_ring, line, len, info);
 
-    MacroTable table;
-    MacroState state = M_OTHER;
+        /* the buffer is only needed for the .am file */
+        if (!ctx->options.write_expanded_file)
+            return 0;
+    }
+    return line_buffer_append_span(&ctx->expanded_source, line, len, info);
+}
 
-    char base_name[PATH_MAX];
-    char output_path[PATH_MAX];
+/* Hands source line line_number, as indexed, to the first pass. Returns 0 on success, -1 if out of memory */
+static int emit_line(AssemblerContext *ctx, const IndexedLine *line, int line_number)
+{
+    LineInfo info;
+
+    info.source_line = line_number;
+    info.kind = line->kind;
+    info.tokens = NULL;
+    return emit_line_span(ctx, ctx->source + line->offset, line->length, &info);
+}
 
-    /* Initialize macro table */
-    init_macro_table(&table);
+/*
+ * Emits the body of macro; every line is reported at the line of the macro
+ * call. The lines go out with the tokens recorded at definition time, so a
+ * macro is lexed once however often it is called.
+ */
+static int emit_macro(AssemblerContext *ctx, const Macro *macro, int source_line)
+{
+    LineInfo info;
+    int i;
 
-    /* Prepare output path */
-    if (extract_basename_no_ext(input_path, base_name, sizeof(base_name)) != 0)
+    info.source_line = source_line;
+    for (i = 0; i < macro->line_count; i++)
     {
-        fprintf(stderr, "❌ Failed to extract basename from: %s\n", input_path);
-        return 1;
-    }
+        const MacroLine *line = get_macro_body_line(ctx->macro_table, macro, i);
 
-    if (ensure_directory_exists("output") != 0)
-    {
-        fprintf(stderr, "❌ Failed to create or access 'output/' directory\n");
-        return 1;
+        info.kind = line->kind;
+        info.tokens = line->tokens;
+        if (emit_line_span(ctx, ctx->source + line->offset, line->length, &info) != 0)
+            return -1;
     }
+    return 0;
+}
 
-    make_output_path(base_name, output_path, sizeof(output_path));
+/* Writes the expanded source to the .am file next to the other outputs */
+static int write_expanded_file(AssemblerContext *ctx)
+{
+    FILE *output;
+    char output_path[PATH_MAX];
 
-    /* Open files */
-    input = fopen(input_path, "r");
-    if (!input)
-    {
-        fprintf(stderr, "❌ Cannot open file for reading: %s\n", input_path);
-        return 1;
-    }
+    /* the output directory is created once by the driver, before the first input file */
+    context_output_path(ctx, ".am", output_path, sizeof(output_path));
 
     output = fopen(output_path, "w");
     if (!output)
     {
         fprintf(stderr, "❌ Cannot open file for writing: %s\n", output_path);
-        fclose(input);
         return 1;
     }
 
-    printf("🔧 Preprocessing: %s → %s\n", input_path, output_path);
+    line_buffer_write(&ctx->expanded_source, output);
+    fclose(output);
+
+    LOG_INFO(LOG_PREPROCESSOR, ("🔧 Expanded source written to: %s\n", output_path));
+    return 0;
+}
+
+int run_pre_assembler(AssemblerContext *ctx)
+{
+    return preprocess_source(ctx, ctx->status_info);
+}
+
+int preprocess_source(AssemblerContext *ctx, StatusInfo *status_info)
+{
+    const char *input_path = ctx->input_path;
+    MacroTable *table = ctx->macro_table;
+    LineIndex *index = &ctx->line_index;
+    size_t macro_name_offset = 0; /* name of the macro being defined, as a span of the source */
+    size_t macro_name_length = 0;
+    int macro_first_line = 0;     /* its first body line in the table */
+    int macro_line_count = 0;
+    int line_number;
+    int out_of_memory = 0;
+    Tokens tokens;
+    const Macro *macro;
+
+    MacroState state = M_OTHER;
+
+    /* the source is already in memory (mapped, read, or handed over by a library caller); index it once */
+    if (line_index_build(index, ctx->source, ctx->source_length) != 0)
+    {
+        fprintf(stderr, "❌ Out of memory while indexing: %s\n", input_path);
+        return 1;
+    }
+    reset_macro_table(table, ctx->source);
+    tokens_init(&tokens);
+
+    LOG_INFO(LOG_PREPROCESSOR, ("🔧 Preprocessing: %s\n", input_path));
 
-    /* Process line by line */
-    while (fgets(line, sizeof(line), input) != NULL)
+    /* Process line by line, in place; the expanded source goes straight to the first pass */
+    for (line_number = 1; line_number <= index->count && !out_of_memory; line_number++)
     {
-        Tokens tokens = tokenize_line(line);
+        const IndexedLine *line = &index->lines[line_number - 1];
+        const char *first;
 
-        if (tokens.count == 0)
+        /* blank and comment lines outside a macro pass through untouched; inside one they are body lines */
+        if ((line->kind == LINE_BLANK || line->kind == LINE_COMMENT) && state == M_OTHER)
         {
-            /* Preserve blank lines */
-            fputs(line, output);
-            line_number++;
+            out_of_memory = emit_line(ctx, line, line_number) != 0;
             continue;
         }
 
-        const char *first = tokens.tokens[0];
+        if (tokenize_span(&tokens, ctx->source + line->offset, line->length) != 0)
+        {
+            out_of_memory = 1;
+            break;
+        }
+        first = token_text(&tokens, 0);
 
         if (state == M_CODE)
         {
-            if (is_macro_end(first))
+            if (line->kind == LINE_MACRO_END)
             {
                 /* End of macro */
                 if (macro_line_count == 0)
                     write_error_log(status_info, W404_MACRO_EMPTY, -line_number);
 
-                add_macro(&table, macro_name, macro_lines, macro_line_count);
+                if (!add_macro(table, macro_name_offset, macro_name_length, macro_first_line, macro_line_count))
+                    out_of_memory = 1;
 
                 macro_line_count = 0;
-                macro_name[0] = '\0';
+                macro_name_length = 0;
                 state = M_OTHER;
             }
             else
             {
-                /* Accumulate macro body */
-                if (macro_line_count < MAX_LINES_PER_MACRO)
-                {
-                    strncpy(macro_lines[macro_line_count], line, MAX_LINE_LEN - 1);
-                    macro_lines[macro_line_count][MAX_LINE_LEN - 1] = '\0';
-                    macro_line_count++;
-                }
-                else
-                {
-                    write_error_log(status_info, E400_MACRO_UNDEFINED, line_number);
-                }
+                /* Accumulate macro body: the line stays in the source, the table keeps its span and tokens */
+                if (!add_macro_line(table, line, &tokens))
+                    out_of_memory = 1;
+                macro_line_count++;
             }
         }
         else if (state == M_OTHER)
         {
-            if (is_comment(first))
+            if (line->kind == LINE_MACRO_START)
             {
-                fputs(line, output);
-            }
-            else if (is_macro_start(first))
-            {
-                if (tokens.count < 2 || is_macro_end(tokens.tokens[1]) || tokens.tokens[1][0] == '\0')
+                if (tokens.count < 2 || is_macro_end(token_text(&tokens, 1)) || token_text(&tokens, 1)[0] == '\0')
                 {
                     write_error_log(status_info, W402_MACRO_UNNAMED, line_number);
                     state = M_CODE;
+                    macro_first_line = table->line_count;
                     macro_line_count = 0;
                     continue;
                 }
 
-                strncpy(macro_name, tokens.tokens[1], MAX_LINE_LEN - 1);
-                macro_name[MAX_LINE_LEN - 1] = '\0';
+                macro_name_offset = line->offset + tokens.spans[1].offset;
+                macro_name_length = tokens.spans[1].length;
 
-                if (macro_exists(&table, macro_name))
+                if (get_macro(table, token_text(&tokens, 1)) != NULL)
                 {
                     write_error_log(status_info, W403_MACRO_REDEFINED, line_number);
                     continue;
                 }
 
+                macro_first_line = table->line_count;
                 macro_line_count = 0;
                 state = M_CODE;
             }
-            else if (is_macro_end(first))
+            else if (line->kind == LINE_MACRO_END)
             {
                 write_error_log(status_info, W402_MACRO_UNNAMED, line_number);
             }
-            else if (macro_exists(&table, first))
+            else if ((macro = get_macro(table, first)) != NULL)
             {
-                Macro *macro = get_macro(&table, first);
+                /* one lookup resolves the call; the macro goes straight to expansion */
                 if (macro->line_count == 0)
                     write_error_log(status_info, W404_MACRO_EMPTY, line_number);
 
-                expand_macro(&table, first, output);
+                out_of_memory = emit_macro(ctx, macro, line_number) != 0;
             }
             else
             {
-                fputs(line, output);
+                out_of_memory = emit_line(ctx, line, line_number) != 0;
             }
         }
-
-        line_number++;
     }
 
-    fclose(input);
-    fclose(output);
+    tokens_free(&tokens);
 
-    /* Optional: print valid macros only */
-    printf("\n📦 Macro Table:\n");
-    int i,j;
-    for (i = 0; i < table.count; i++)
+    if (out_of_memory)
     {
-        Macro *macro = &table.macros[i];
-        if (macro->name[0] == '\0')
-            continue;
-
-        printf("Macro: %s\n", macro->name);
-        for ( j = 0; j < macro->line_count; j++)
-        {
-            printf("  Line %d: %s", j + 1, macro->lines[j]);
-        }
-        if (macro->line_count == 0)
-            printf("  (empty)\n");
+        fprintf(stderr, "❌ Out of memory while expanding: %s\n", input_path);
+        return 1;
     }
 
+    /* the .am file is a debugging aid only; the first pass reads the buffer */
+    if (ctx->options.write_expanded_file && write_expanded_file(ctx) != 0)
+        return 1;
+
+    if (log_is_enabled(LOG_LEVEL_DEBUG, LOG_PREPROCESSOR))
+        print_macro_table(table);
+
     return 0;
 }
@@ -1,12 +1,16 @@
 #ifndef PRE_ASSEMBLER_H
 #define PRE_ASSEMBLER_H
-#define MAX_MACROS 100
-#define MAX_MACRO_LINES 50
-#define MAX_MACROS 100
-#define MAX_LINE_LEN 81 /*TODO: should be in centralized definitions file*/
 #include "../common/errors/errors.h"
+#include "../assembler/context.h"
 
-int run_pre_assembler(const char *filename, StatusInfo *status_info);
+/*
+ * Expands the macros of ctx->source into ctx->expanded_source, or into
+ * ctx->line_ring when one is set. Diagnostics go to ctx->status_info.
+ */
+int run_pre_assembler(AssemblerContext *ctx);
+
+/* Same as run_pre_assembler, logging to status_info (used when running on its own thread) */
+int preprocess_source(AssemblerContext *ctx, StatusInfo *status_info);
 
 int is_macro_start(const char *line); /*Detects 'mcro'*/
 int is_macro_end(const char *line);   /*Detects 'mcroend'*/
@@ -4,16 +4,14 @@
 #include <ctype.h>
 #include "first_pass.h"
 
-char *my_strdup(const char *s);
-char *trim_whitespace(char *str);
 void init_symbol_table()
 {
 }
 
-static char *dup_label_trim_colon(const char *s)
+/* Interns s without surrounding whitespace and one trailing ':' */
+static const char *intern_label_trim_colon(Interner *labels, const char *s)
 {
-    size_t start = 0, end, len;
-    char *out;
+    size_t start = 0, end;
 
     if (s == NULL)
         return NULL;
@@ -44,42 +42,86 @@ static char *dup_label_trim_colon(const char *s)
     if (end < start)
         end = start; /* empty result */
 
-    len = end - start;
-    out = (char *)malloc(len + 1);
-    if (out == NULL)
-        return NULL;
+    return intern_span(labels, s + start, end - start);
+}
+
+/*
+ * Returns the next line of the preprocessor output, or NULL at the end.
+ * Lines come from the pipeline ring while the pre-assembler runs alongside,
+ * otherwise from the expanded source buffer (cursor is the next line index).
+ * Ring lines are spans of the source; each is copied whole into ring_line,
+ * grown as needed, to be '\0' terminated. info receives the line's source
+ * line number, its kind as classified by the line index and, for lines of an
+ * expanded macro, its tokens.
+ */
+static const char *next_expanded_line(AssemblerContext *ctx, int *cursor, char **ring_line, size_t *ring_line_size,
+                                      LineInfo *info)
+{
+    const LineBuffer *source = &ctx->expanded_source;
+
+    if (ctx->line_ring)
+    {
+        const char *text;
+        size_t length;
+
+        if (!line_ring_pop(ctx->line_ring, &text, &length, info))
+            return NULL;
+        if (length + 1 > *ring_line_size)
+        {
+            char *grown = realloc(*ring_line, length + 1);
+            if (!grown)
+            {
+                LOG_ERROR(LOG_FIRST_PASS, ("Failed to allocate line buffer\n"));
+                ctx->status_info->is_out_of_memory = 1;
+                return NULL;
+            }
+            *ring_line = grown;
+            *ring_line_size = length + 1;
+        }
+        memcpy(*ring_line, text, length);
+        (*ring_line)[length] = '\0';
+        return *ring_line;
+    }
 
-    /* copy + NUL */
-    if (len > 0)
-        memcpy(out, s + start, len);
-    out[len] = '\0';
-    return out;
+    if (*cursor >= source->line_count)
+        return NULL;
+    *info = *line_buffer_info(source, *cursor);
+    return line_buffer_line(source, (*cursor)++);
 }
 
 /* -------------- MAIN DRIVER -------------- */
-void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC, EncodedList *encoded_list, StatusInfo *status_info)
+void run_first_pass(AssemblerContext *ctx)
 {
     /*BUG: LABEL: (blank) -> [new_line]: .directive | instruction => is not read properly*/
+    Table *symbol_table = ctx->symbol_table;
+    ASTNode **head = &ctx->ast_head;
+    MachineImage *image = &ctx->image;
+    StatusInfo *status_info = ctx->status_info;
+    int *IC = &ctx->IC;
     int is_label_declaration = 0;
+    int is_memory_exceeded = 0;
     int DC = 0;
-    Table *ext_table = table_create(), *ent_table = table_create();
-    FILE *file = fopen(filename, "r");
-    char line[1024]; /* move to machine definitions */
-    int line_number = 1;
-    Tokens tokenized_line;
+    Table *ext_table = table_create_interned(), *ent_table = table_create_interned();
+    int line_index = 0;
+    const char *line;
+    char *ring_line = NULL; /* copy of the current pipeline line */
+    size_t ring_line_size = 0;
+    int line_number = 0;
+    Tokens tokens;
+    const Tokens *tokenized_line = &tokens;
+    LineInfo line_info;
     char *leader;
     ASTNode *tail = NULL;
-    char *clean_label;
+    const char *clean_label;
     ErrorInfo err;
-    if (!file)
-    {
-        perror("Error opening file");
-        return;
-    }
-    printf("\n\033[1;35mFILENAME:\033[0m %s\n", filename);
+    LOG_INFO(LOG_FIRST_PASS, ("\n\033[1;35mFILENAME:\033[0m %s\n", ctx->input_path));
+    tokens_init(&tokens);
 
-    while (fgets(line, sizeof(line), file))
+    /* walk the preprocessor output in memory; line numbers refer to the .as file */
+    while ((line = next_expanded_line(ctx, &line_index, &ring_line, &ring_line_size, &line_info)) != NULL)
     {
+        line_number = line_info.source_line;
+
         /* PRINTING */
         PRINT_LINE(line_number);
         PRINT_RAW_LINE(line);
@@ -88,21 +130,46 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
         if (strlen(line) > MAX_LINE_LEN)
             write_error_log(status_info, E701_MEMORY_LINE_CHAR_LIMIT, line_number);
 
-        /* LOOP VARIABLES */
-        tokenized_line = tokenize_line(line);
+        /* blank and comment lines are known from the line index; no need to tokenize them */
+        if (line_info.kind == LINE_BLANK || line_info.kind == LINE_COMMENT)
+            continue;
+
+        /* LOOP VARIABLES: macro lines were tokenized once, at their definition */
+        if (line_info.tokens)
+        {
+            tokenized_line = line_info.tokens;
+        }
+        else
+        {
+            if (tokenize_line(&tokens, line) != 0)
+            {
+                LOG_ERROR(LOG_FIRST_PASS, ("Failed to allocate line tokens\n"));
+                status_info->is_out_of_memory = 1;
+                break;
+            }
+            tokenized_line = &tokens;
+        }
         int leader_idx = 0;
-        leader = tokenized_line.tokens[0];
+        leader = token_text(tokenized_line, 0);
         PRINT_TOKEN(leader);
         StatementType statement_type;
-        SymbolInfo *symbol_info = malloc(sizeof(SymbolInfo));
+        SymbolInfo *symbol_info;
 
         /* IGNORE NON CODE LINES */
         if (is_comment_line(leader) || is_empty_line(tokenized_line))
         {
-            line_number++;
             continue;
         }
 
+        /* the symbol this line may declare; lives in the arena until the context is reset */
+        symbol_info = arena_alloc(&ctx->arena, sizeof(SymbolInfo));
+        if (symbol_info == NULL)
+        {
+            LOG_ERROR(LOG_FIRST_PASS, ("Failed to allocate SymbolInfo\n"));
+            break;
+        }
+        memset(symbol_info, 0, sizeof(SymbolInfo));
+
         /* LABEL DECLARATION FLAG, LEADER TOKEN INCREMENT */
         if (is_symbol_declare(leader))
         {
@@ -112,25 +179,12 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
                 write_error_log(status_info, E501_LABEL_RESERVED, line_number);
             is_label_declaration = 1;
             PRINT_LABEL_FOUND(leader);
-            int is_declared = table_lookup(symbol_table, leader);
-
-            if (is_declared)
+            clean_label = intern_label_trim_colon(ctx->labels, leader);
+            if (clean_label != NULL && table_lookup(symbol_table, clean_label))
                 write_error_log(status_info, E502_LABEL_REDEFINED, line_number);
-            else
-            {
-                clean_label = dup_label_trim_colon(leader);
-                if (clean_label == NULL)
-                {
-                    /* handle OOM */
-                }
-                else
-                {
-                    *symbol_info->name = clean_label; /* NOTE: no '*' deref */
-                }
-            }
 
             /* move leader to next token */
-            leader = tokenized_line.tokens[++leader_idx];
+            leader = token_text(tokenized_line, ++leader_idx);
             PRINT_TOKEN(leader);
         }
 
@@ -141,24 +195,24 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
         statement_type = get_statement_type(leader);
         switch (statement_type)
         {
-        /* PARSE LINE, ENCODE LINE WORDS, LABEL ->SYMBOL_TABLE INSERT, AST APPEND
-        ENCODED_LIST INSERT, IC INCREMENT */
+        /* PARSE LINE, LABEL ->SYMBOL_TABLE INSERT, AST APPEND,
+        ENCODE LINE WORDS INTO THE CODE IMAGE, IC INCREMENT */
         case INSTRUCTION_STATEMENT:
         {
 
-            EncodedLine *encoded_line = malloc(sizeof(EncodedLine));
             Opcode opcode = get_opcode(leader);
             ASTNode *new_node;
             PRINT_INSTRUCTION(opcode);
-            new_node = parse_instruction_line(line_number, tokenized_line, leader_idx);
-            if (new_node->content.instruction.error_code != SUCCESS_100)
+            new_node = parse_instruction_line(&ctx->arena, ctx->labels, line_number, tokenized_line, leader_idx);
+            /* no node: the operand count does not match the opcode */
+            if (!new_node)
             {
-                write_error_log(status_info, new_node->content.instruction.error_code, line_number);
+                write_error_log(status_info, E601_INSTRUCTION_FORMAT_INVALID, line_number);
                 break;
             }
-            if (!new_node)
+            if (new_node->content.instruction.error_code != SUCCESS_100)
             {
-                write_error_log(status_info, E601_INSTRUCTION_FORMAT_INVALID, line_number);
+                write_error_log(status_info, new_node->content.instruction.error_code, line_number);
                 break;
             }
 
@@ -166,56 +220,47 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
 
             if (new_node->status != ERR1)
             {
-                encoded_line = encode_instruction_line(new_node, leader_idx);
-
                 /* SYMBOL_TABLE INSERTION, IC++ */
                 if (is_label_declaration > 0)
                 {
                     symbol_info->type = SYMBOL_CODE;
                     symbol_info->address = *IC;
+                    symbol_info->name = clean_label;
                     /* insert to table with *IC before Instruction increment as address */
                     if (table_insert(symbol_table, clean_label, symbol_info))
                         PRINT_LABEL_INSERT(clean_label, *IC);
                     else
-                        printf("[Insert Error] Failed to insert label\n");
+                        LOG_ERROR(LOG_FIRST_PASS, ("[Insert Error] Failed to insert label\n"));
 
                     is_label_declaration = -1;
                 }
 
-                /* ENCODED LIST INSERTION */
-                if (encoded_list->head == NULL)
-                {
-                    encoded_list->head = encoded_line;
-                    encoded_list->tail = encoded_line;
-                }
-                else
-                {
-                    encoded_list->tail->next = encoded_line;
-                    encoded_list->tail = encoded_line;
-                }
-                encoded_list->size++;
-
-                /* IC INCREMENT */
-                *IC += encoded_line->words_count;
+                /* CODE IMAGE, IC INCREMENT */
+                *IC += encode_instruction_line(image, new_node);
             }
         }
         break;
         /* PARSE, ENCODE DATA WORDS, DC INCREMENT, AST APPEND,
-        ENT & EXT HANDLE, LABEL or EXT ->SYMBOL TABLE INSERT, ENCODED LINE INSERT */
+        ENT & EXT HANDLE, LABEL or EXT ->SYMBOL TABLE INSERT */
         case DIRECTIVE_STATEMENT:
         {
-            EncodedLine *encoded_line = malloc(sizeof(EncodedLine));
             /* PRINTS */
             PRINT_DIRECTIVE(leader);
             int pre_inc_DC = DC; /* Save DC before increment */
-            char *label_token;
+            const char *label_token = NULL;
             /* Parse directive and update DC */
-            ASTNode *node = parse_directive_line(line_number, tokenized_line, leader_idx, &DC);
+            ASTNode *node = parse_directive_line(&ctx->arena, line_number, tokenized_line, leader_idx, &DC);
+            /* no node: the directive's values could not be allocated */
+            if (!node)
+            {
+                write_error_log(status_info, E700_MEMORY_PROGRAM_WORD_LIMIT, line_number);
+                break;
+            }
             if(node->content.directive.error_code != SUCCESS_100){
                 write_error_log(status_info,node->content.directive.error_code,line_number);
             }
-            /* ENCODE DATA WORDS, DC INCREMENT */
-            encoded_line = encode_directive_line(node, leader_idx);
+            /* ENCODE DATA WORDS INTO THE DATA IMAGE */
+            encode_directive_line(image, node);
 
             /* AST APPEND */
             append_ast_node(head, &tail, node);
@@ -227,42 +272,22 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
             if (node->content.directive.type == ENTRY)
             {
 
-                clean_label = dup_label_trim_colon(tokenized_line.tokens[leader_idx + 1]);
-                *symbol_info->name = clean_label;
+                clean_label = intern_label_trim_colon(ctx->labels, token_text(tokenized_line, leader_idx + 1));
                 int address = line_number;
                 if (is_label_declaration > 0)
                 {
                     insert_entry_label(ent_table, clean_label, symbol_info->address);
                     symbol_info->is_entry = 1;
-                    line_number++;
-                    if (encoded_line != NULL)
-                    {
-                        if (encoded_list->head == NULL)
-                        {
-                            encoded_list->head = encoded_line;
-                            encoded_list->tail = encoded_line;
-                        }
-                        else
-                        {
-                            encoded_list->tail->next = encoded_line;
-                            encoded_list->tail = encoded_line;
-                        }
-                        encoded_list->size++;
-                    }
                     continue;
                 }
 
-                char *str_name = tokenized_line.tokens[leader_idx + 1];
-                label_token = malloc(strlen(tokenized_line.tokens[leader_idx + 1]));
-                strncpy(label_token, tokenized_line.tokens[leader_idx + 1], strlen(str_name));
-
                 insert_entry_label(ent_table, clean_label, address);
             }
             else if (node->content.directive.type == EXTERN)
             {
                 /* Get the label token after directive */
-                char *token = tokenized_line.tokens[leader_idx + 1];
-                label_token = copy_label_token(token);
+                char *token = token_text(tokenized_line, leader_idx + 1);
+                label_token = intern_string(ctx->labels, token);
                 /* Add to extern table with pre_inc_dc address */
                 symbol_info->type = SYMBOL_EXTERN;
                 symbol_info->is_extern = 1;
@@ -279,27 +304,12 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
                     warn("entry or extern used in label declaration");
 
                 symbol_info->address = symbol_info->is_extern > 0 ? 0 : pre_inc_DC;
+                symbol_info->name = clean_label;
 
                 if (table_insert(symbol_table, clean_label, symbol_info))
                     PRINT_LABEL_INSERT(clean_label, pre_inc_DC); /* Confirm insertion */
                 else
-                    printf("[Insert Error] Failed to insert label\n");
-            }
-
-            /* ENCODED LINE LIST INSERT */
-            if (encoded_line != NULL)
-            {
-                if (encoded_list->head == NULL)
-                {
-                    encoded_list->head = encoded_line;
-                    encoded_list->tail = encoded_line;
-                }
-                else
-                {
-                    encoded_list->tail->next = encoded_line;
-                    encoded_list->tail = encoded_line;
-                }
-                encoded_list->size++;
+                    LOG_ERROR(LOG_FIRST_PASS, ("[Insert Error] Failed to insert label\n"));
             }
         }
         break;
@@ -319,25 +329,33 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
         if (total > 256)
         {
             write_error_log(status_info, E700_MEMORY_PROGRAM_WORD_LIMIT, line_number);
-            return;
+            is_memory_exceeded = 1;
+            break;
         }
-
-        line_number++;
     }
+    tokens_free(&tokens);
+    free(ring_line);
+    ctx->DC = DC;
     int total = *IC + DC - 100;
-    if (total > 256)
+    if (is_memory_exceeded || total > 256)
     {
-        write_error_log(status_info, E700_MEMORY_PROGRAM_WORD_LIMIT, line_number);
+        if (!is_memory_exceeded)
+            write_error_log(status_info, E700_MEMORY_PROGRAM_WORD_LIMIT, line_number);
+        table_destroy(ext_table, free);
+        table_destroy(ent_table, free);
         return;
     }
     /* tables print */
-    printf("\n\033[1;36mSYMBOL TABLE:\033[0m\n");
-    table_print(symbol_table, print_symbol);
-    printf("\n\033[1;36mEXTERN TABLE:\033[0m\n");
-    table_print(ext_table, print_extern);
-    printf("\n\033[1;36mENTRY TABLE:\033[0m\n");
-    table_print(ent_table, print_entry);
-    printf("_____________________________________\n");
+    if (log_is_enabled(LOG_LEVEL_DEBUG, LOG_FIRST_PASS))
+    {
+        log_printf("\n\033[1;36mSYMBOL TABLE:\033[0m\n");
+        table_print(symbol_table, print_symbol);
+        log_printf("\n\033[1;36mEXTERN TABLE:\033[0m\n");
+        table_print(ext_table, print_extern);
+        log_printf("\n\033[1;36mENTRY TABLE:\033[0m\n");
+        table_print(ent_table, print_entry);
+        log_printf("_____________________________________\n");
+    }
 
     /* FLAG ENTRY SYMBOLS */
     TableNode *curr = ent_table->head;
@@ -355,48 +373,47 @@ void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC
         ent_info->ref_line = *ref_line;
         curr = curr->next;
     }
-    int ICF = *IC + 1;
 
-    fclose(file);
+    /* entry/extern tables only live for the duration of this pass */
+    table_destroy(ext_table, free);
+    table_destroy(ent_table, free);
 }
 
 /* -------------- parsers -------------- */
-ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_idx, int *DC_ptr)
+ASTNode *parse_directive_line(Arena *arena, int line_num, const Tokens *tokenized_line, int leader_idx, int *DC_ptr)
 {
     const char *delimeter = ",";
-    int data_size = tokenized_line.count - 1;
+    int data_size = tokenized_line->count - 1;
     int data_val_idx;
-    int data_count;
+    int data_count = 0;
     
-    DirectiveInfo *info = malloc(sizeof(DirectiveInfo));
-    if (!info)
-    {
-        printf("Failed to allocate DirectiveInfo\n");
-        return NULL;
-    }
+    /* copied into the AST node by create_directive_node */
+    DirectiveInfo directive;
+    DirectiveInfo *info = &directive;
+    memset(info, 0, sizeof(DirectiveInfo));
     info->status = SUCCESS;
     info->error_code = SUCCESS_100;
-    info->type = get_directive_type(tokenized_line.tokens[leader_idx]);
+    info->type = get_directive_type(token_text(tokenized_line, leader_idx));
 
     switch (info->type)
     {
     case DATA:
     {
         /* allocate values array */
-        int *values = malloc((sizeof(int)) * data_size);
+        int *values = arena_alloc(arena, (sizeof(int)) * data_size);
         int i = 0;
         if (!values)
         {
-            printf("Failed to allocate values array\n");
-            free(info);
+            LOG_ERROR(LOG_FIRST_PASS, ("Failed to allocate values array\n"));
             return NULL;
         }
+        memset(values, 0, (sizeof(int)) * data_size);
 
         /* parese data values (integers), handling errors*/
         for (i = 0; i < data_size; i++)
         {
             data_val_idx = leader_idx + 1 + i;
-            char *data_value_token = tokenized_line.tokens[data_val_idx];
+            char *data_value_token = token_text(tokenized_line, data_val_idx);
             int is_missing_val = strcmp(data_value_token, delimeter) == 0;
 
             /*TODO: handle error , , empty value ERR CODE*/
@@ -405,7 +422,7 @@ ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_id
             /* if token was 2 (or more) adjacent ',' in a row */
             if (is_missing_val)
             {
-                printf("ERROR: MISSING VALUE\n");
+                LOG_DEBUG(LOG_FIRST_PASS, ("ERROR: MISSING VALUE\n"));
                 /* handle error */
                 info->status = ERR1;
                 values[i] = err;
@@ -429,78 +446,79 @@ ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_id
     {
         int i;
         /* validate .mat directive format */
-        char size_row = tokenized_line.tokens[leader_idx + 2][0];
-        char size_col = tokenized_line.tokens[leader_idx + 2][3];
+        char size_row = token_text(tokenized_line, leader_idx + 2)[0];
+        char size_col = token_text(tokenized_line, leader_idx + 2)[3];
 
         /* go over each char:
-        tokenized_line.tokens[leader_idx + 1] = '['
-        tokenized_line.tokens[leader_idx + 2] should be number
+        token leader_idx + 1 = '['
+        token leader_idx + 2 should be number
         keep adding number chars untill hitting ]
         skip white space, when hitting [, start adding chars to col as long as numbers and char is not ]*/
         int j = 0;
-        if (tokenized_line.tokens[leader_idx + 1][0] != '[')
+        if (token_text(tokenized_line, leader_idx + 1)[0] != '[')
         {
-            printf("INDEX NOT STARTING WITH [");
+            LOG_DEBUG(LOG_FIRST_PASS, ("INDEX NOT STARTING WITH [\n"));
             info->status = ERR1;
         }
 
         char size_row_buffer[4] = {0};
         char size_col_buffer[4];
-        while (is_valid_num_char(tokenized_line.tokens[leader_idx + 2][j]) && j < 4)
+        while (is_valid_num_char(token_text(tokenized_line, leader_idx + 2)[j]) && j < 4)
         {
-            size_row_buffer[j] = tokenized_line.tokens[leader_idx + 2][j];
+            size_row_buffer[j] = token_text(tokenized_line, leader_idx + 2)[j];
             j++;
         }
 
-        if (tokenized_line.tokens[leader_idx + 2][j] != ']')
+        if (token_text(tokenized_line, leader_idx + 2)[j] != ']')
         {
             info->status = ERR1;
-            printf("INDEX NOT ENDING WITH ]");
+            LOG_DEBUG(LOG_FIRST_PASS, ("INDEX NOT ENDING WITH ]\n"));
         }
         size_row_buffer[j] = '\0';
         j++;
-        if (tokenized_line.tokens[leader_idx + 2][j] != '[')
+        if (token_text(tokenized_line, leader_idx + 2)[j] != '[')
         {
-            printf("COL INDEX NOT STARTING WITH [");
+            LOG_DEBUG(LOG_FIRST_PASS, ("COL INDEX NOT STARTING WITH [\n"));
             info->status = ERR1;
         }
 
         int k = 0;
         j++;
-        while (is_valid_num_char(tokenized_line.tokens[leader_idx + 2][j]) && k < 4)
+        while (is_valid_num_char(token_text(tokenized_line, leader_idx + 2)[j]) && k < 4)
         {
-            size_col_buffer[k] = tokenized_line.tokens[leader_idx + 2][j];
+            size_col_buffer[k] = token_text(tokenized_line, leader_idx + 2)[j];
             k++;
             j++;
         }
         size_col_buffer[k] = '\0';
 
-        if (tokenized_line.tokens[leader_idx + 2][j] != ']')
+        if (token_text(tokenized_line, leader_idx + 2)[j] != ']')
         {
             info->status = ERR1;
-            printf("COL INDEX NOT ENDING WITH ]");
+            LOG_DEBUG(LOG_FIRST_PASS, ("COL INDEX NOT ENDING WITH ]\n"));
         }
 
         /* adjust data count */
         data_size = atoi(size_row_buffer) * atoi(size_col_buffer);
 
         /* allocate values array */
-        int *values = malloc((sizeof(int)) * data_size);
+        int *values = arena_alloc(arena, (sizeof(int)) * data_size);
         if (!values)
         {
-            printf("Failed to allocate values array\n");
-            free(info);
+            LOG_ERROR(LOG_FIRST_PASS, ("Failed to allocate values array\n"));
             return NULL;
         }
+        /* cells without an initializer stay zero (W617) */
+        memset(values, 0, (sizeof(int)) * data_size);
 
         /* parese data values (integers), handling errors*/
         for (i = 0; i < data_size; i++)
         {
             int mat_increment = 2;
             int data_val_idx = leader_idx + 1 + i + mat_increment;
-            char *data_value_token = tokenized_line.tokens[data_val_idx];
-            if(tokenized_line.tokens[data_val_idx][0]=='\0'){
-                printf("warning, completing zeros to mat");
+            char *data_value_token = token_text(tokenized_line, data_val_idx);
+            if(token_text(tokenized_line, data_val_idx)[0]=='\0'){
+                LOG_DEBUG(LOG_FIRST_PASS, ("warning, completing zeros to mat\n"));
                 info->error_code = W617_OPERAND_MAT_INITIALIZED_UNDER;
             }
             int is_missing_val = strcmp(data_value_token, delimeter) == 0;
@@ -511,7 +529,7 @@ ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_id
             /* if token was 2 (or more) adjacent ',' in a row */
             if (is_missing_val)
             {
-                printf("ERROR: MISSING VALUE\n");
+                LOG_DEBUG(LOG_FIRST_PASS, ("ERROR: MISSING VALUE\n"));
                 /* handle error */
                 values[i] = err;
                 info->status = ERR1;
@@ -536,23 +554,25 @@ ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_id
     {
         int i;
         int data_val_idx = leader_idx + 1;
-        char *data_val_token = tokenized_line.tokens[data_val_idx];
+        char *data_val_token = token_text(tokenized_line, data_val_idx);
         data_size = strlen(data_val_token);
         char delimeter = '"';
         int str_len = data_size - 2;
-        char *str_buffer = malloc(str_len + 1);
-        if (!str_buffer)
+        char *str_buffer;
+
+        if (data_size < 2 || data_val_token[0] != '"' || data_val_token[data_size - 1] != '"')
         {
-            printf("ERROR: failed to allocate string buffer\n");
+            LOG_DEBUG(LOG_FIRST_PASS, ("ERROR: invalid string token: %s\n", data_val_token));
             break;
         }
 
-        if (data_size < 2 || data_val_token[0] != '"' || data_val_token[data_size - 1] != '"')
+        /* the string (with its terminator) is kept by the AST node */
+        str_buffer = arena_alloc(arena, str_len + 1);
+        if (!str_buffer)
         {
-            printf("ERROR: invalid string token: %s\n", data_val_token);
+            LOG_ERROR(LOG_FIRST_PASS, ("ERROR: failed to allocate string buffer\n"));
             break;
         }
-
         for (i = 0; i < str_len; i++)
         {
             data_count++;
@@ -563,15 +583,9 @@ ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_id
         str_buffer[str_len] = '\0';
         (*DC_ptr) += str_len + 1;
         PRINT_DC(*DC_ptr);
-        printf("string is: %s", str_buffer);
+        LOG_TRACE(LOG_FIRST_PASS, ("string is: %s\n", str_buffer));
         info->params.data.size = str_len + 1;
-        int k;
-        info->params.str = malloc(sizeof(char) * info->params.data.size);
-        for (k = 0; k < info->params.data.size; k++)
-        {
-            info->params.str[k] = str_buffer[k];
-        }
-        info->params.str[k] = '\0';
+        info->params.str = str_buffer; /* includes the terminating '\0' */
     }
     break;
     case ERROR_DIRECTIVE:
@@ -581,107 +595,99 @@ ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_id
     }
 
     /*info->params.data.size = data_size;*/
-    printf("data size: %d\n", info->params.data.size);
+    LOG_TRACE(LOG_FIRST_PASS, ("data size: %d\n", info->params.data.size));
     data_count = 0;
-    return create_directive_node(line_num, tokenized_line.tokens[leader_idx], info);
+    return create_directive_node(arena, line_num, token_text(tokenized_line, leader_idx), info);
 }
 
-ASTNode *parse_instruction_line(int line_num, Tokens tokenized_line, int leader_idx)
+ASTNode *parse_instruction_line(Arena *arena, Interner *labels, int line_num, const Tokens *tokenized_line, int leader_idx)
 {
     /*TODO: memeset*/
     InstructionInfo info;
     info.error_code = SUCCESS_100;
-    Opcode opcode = get_opcode(tokenized_line.tokens[leader_idx]);
+    Opcode opcode = get_opcode(token_text(tokenized_line, leader_idx));
     int expected_num_op = expect_operands(opcode);
     info.opcode = opcode;
     info.src_op.mode = NONE;
     info.dest_op.mode = NONE;
     info.status = SUCCESS;
-    printf("--> Expected operands: %d\n", expected_num_op);
-    int operands_count = tokenized_line.count - (leader_idx + 2);
+    LOG_TRACE(LOG_FIRST_PASS, ("--> Expected operands: %d\n", expected_num_op));
+    int operands_count = tokenized_line->count - (leader_idx + 2);
     if (expected_num_op != operands_count)
         return NULL;
 
     switch (expected_num_op)
     {
     case 1:
-        PRINT_OPERAND(1, tokenized_line.tokens[leader_idx + 1]);
-        info.error_code = parse_instruction_operand(&(info.dest_op), tokenized_line, leader_idx + 1);
+        PRINT_OPERAND(1, token_text(tokenized_line, leader_idx + 1));
+        info.error_code = parse_instruction_operand(labels, &(info.dest_op), tokenized_line, leader_idx + 1);
         break;
     case 2:
-        PRINT_OPERAND(1, tokenized_line.tokens[leader_idx + 1]);
-        PRINT_OPERAND(2, tokenized_line.tokens[leader_idx + 2]);
-        info.error_code = parse_instruction_operand(&(info.src_op), tokenized_line, leader_idx + 1);
-        ErrorCode dest_error_code = parse_instruction_operand(&(info.dest_op), tokenized_line, leader_idx + 2);
+        PRINT_OPERAND(1, token_text(tokenized_line, leader_idx + 1));
+        PRINT_OPERAND(2, token_text(tokenized_line, leader_idx + 2));
+        info.error_code = parse_instruction_operand(labels, &(info.src_op), tokenized_line, leader_idx + 1);
+        ErrorCode dest_error_code = parse_instruction_operand(labels, &(info.dest_op), tokenized_line, leader_idx + 2);
         if (info.error_code == SUCCESS_100)
         {
             info.error_code = dest_error_code;
         }
         break;
     default:
-        printf("--> No operands expected.\n");
+        LOG_TRACE(LOG_FIRST_PASS, ("--> No operands expected.\n"));
         break;
     }
 
-    return create_instruction_node(line_num, NULL, info);
+    return create_instruction_node(arena, line_num, NULL, info);
 }
 
-ErrorCode parse_instruction_operand(Operand *operand_to_parse, Tokens tokenized_line, int token_idx)
+ErrorCode parse_instruction_operand(Interner *labels, Operand *operand_to_parse, const Tokens *tokenized_line, int token_idx)
 {
 
-    printf("Parsing operand at token index %d: %s\n", token_idx, tokenized_line.tokens[token_idx]);
+    LOG_TRACE(LOG_FIRST_PASS, ("Parsing operand at token index %d: %s\n", token_idx, token_text(tokenized_line, token_idx)));
 
     operand_to_parse->mode = get_mode(tokenized_line, token_idx);
-    printf("Detected addressing mode: %s\n", addressing_mode_name(operand_to_parse->mode));
+    LOG_TRACE(LOG_FIRST_PASS, ("Detected addressing mode: %s\n", addressing_mode_name(operand_to_parse->mode)));
     ErrorCode error_code = SUCCESS_100;
     switch (operand_to_parse->mode)
     {
     case IMMEDIATE:
     {
-        if (!is_valid_immediate_token(tokenized_line.tokens[token_idx]))
+        if (!is_valid_immediate_token(token_text(tokenized_line, token_idx)))
             error_code = E610_OPERAND_IMMEDIATE_INVALID;
-        if (!is_in_bound_immediate_token(tokenized_line.tokens[token_idx]))
+        if (!is_in_bound_immediate_token(token_text(tokenized_line, token_idx)))
             error_code = E611_OPERAND_IMMEDIATE_OUT_OF_BOUNDS;
-        if (is_immediate_float_token(tokenized_line.tokens[token_idx]))
+        if (is_immediate_float_token(token_text(tokenized_line, token_idx)))
             error_code = E612_OPERAND_IMMEDIATE_FLOAT;
-        operand_to_parse->value.immediate_value = atoi(tokenized_line.tokens[token_idx] + 1);
-        printf("Immediate value: %d\n", operand_to_parse->value.immediate_value);
+        operand_to_parse->value.immediate_value = atoi(token_text(tokenized_line, token_idx) + 1);
+        LOG_TRACE(LOG_FIRST_PASS, ("Immediate value: %d\n", operand_to_parse->value.immediate_value));
     }
     break;
     case DIRECT:
-        operand_to_parse->value.label = my_strdup(tokenized_line.tokens[token_idx]);
-        printf("Direct label: %s\n", operand_to_parse->value.label);
+        operand_to_parse->value.label = intern_string(labels, token_text(tokenized_line, token_idx));
+        LOG_TRACE(LOG_FIRST_PASS, ("Direct label: %s\n", operand_to_parse->value.label));
         break;
     case REGISTER:
-        if (!is_valid_register(tokenized_line.tokens[token_idx]))
+        if (!is_valid_register(token_text(tokenized_line, token_idx)))
             error_code = E613_OPERAND_REGISTER_INVALID;
-        operand_to_parse->value.reg_num = atoi(tokenized_line.tokens[token_idx] + 1);
-        printf("Register number: %d\n", operand_to_parse->value.reg_num);
+        operand_to_parse->value.reg_num = atoi(token_text(tokenized_line, token_idx) + 1);
+        LOG_TRACE(LOG_FIRST_PASS, ("Register number: %d\n", operand_to_parse->value.reg_num));
         break;
     case MAT_ACCESS:
     {
 
         /* Parse matrix access: label[reg1][reg2] */
         int str_label_size = 0;
-        int i = 0;
-        while (tokenized_line.tokens[token_idx][str_label_size] != '[')
+        while (token_text(tokenized_line, token_idx)[str_label_size] != '[')
             str_label_size++;
-        char str_label[str_label_size + 1];
-        while (i < str_label_size)
-        {
-            str_label[i] = tokenized_line.tokens[token_idx][i];
-            i++;
-        }
-        str_label[str_label_size] = '\0';
 
-        operand_to_parse->value.index.label = my_strdup(str_label);
+        operand_to_parse->value.index.label = intern_span(labels, token_text(tokenized_line, token_idx), str_label_size);
         char row_reg[3];
         char col_reg[3];
         int j;
         for (j = 0; j < 2; j++)
         {
-            row_reg[j] = tokenized_line.tokens[token_idx][str_label_size + 1 + j];
-            col_reg[j] = tokenized_line.tokens[token_idx][str_label_size + 5 + j];
+            row_reg[j] = token_text(tokenized_line, token_idx)[str_label_size + 1 + j];
+            col_reg[j] = token_text(tokenized_line, token_idx)[str_label_size + 5 + j];
         }
         row_reg[2] = '\0';
         col_reg[2] = '\0';
@@ -689,10 +695,10 @@ ErrorCode parse_instruction_operand(Operand *operand_to_parse, Tokens tokenized_
             error_code = E613_OPERAND_REGISTER_INVALID;
         operand_to_parse->value.index.row_reg_num = atoi(row_reg + 1);
         operand_to_parse->value.index.col_reg_num = atoi(col_reg + 1);
-        printf("Matrix label: %s, Row register: %d, Col register: %d\n",
-               operand_to_parse->value.index.label,
-               operand_to_parse->value.index.row_reg_num,
-               operand_to_parse->value.index.col_reg_num);
+        LOG_TRACE(LOG_FIRST_PASS, ("Matrix label: %s, Row register: %d, Col register: %d\n",
+                                   operand_to_parse->value.index.label,
+                                   operand_to_parse->value.index.row_reg_num,
+                                   operand_to_parse->value.index.col_reg_num));
         memset(row_reg, 0, 0);
         memset(col_reg, 0, 0);
     }
@@ -702,7 +708,7 @@ ErrorCode parse_instruction_operand(Operand *operand_to_parse, Tokens tokenized_
         /*TODO: not entering*/
         /* handle error */
         return ERR1;
-        printf("WE HAVE CASE NONE");
+        LOG_DEBUG(LOG_FIRST_PASS, ("WE HAVE CASE NONE\n"));
     }
     break;
     }
@@ -725,57 +731,20 @@ StatementType get_statement_type(char *leader_token)
 
 DirectiveType get_directive_type(char *dir_token)
 {
-    if (strcmp(dir_token, ".data") == 0)
-        return DATA;
-    else if (strcmp(dir_token, ".string") == 0)
-        return STRING;
-    else if (strcmp(dir_token, ".mat") == 0)
-        return MAT;
-    else if (strcmp(dir_token, ".entry") == 0)
-        return ENTRY;
-    else if (strcmp(dir_token, ".extern") == 0)
-        return EXTERN;
-    else
-        return ERROR_DIRECTIVE;
+    const Keyword *keyword = keyword_lookup(dir_token);
+
+    if (keyword && keyword->kind == KEYWORD_DIRECTIVE)
+        return (DirectiveType)keyword->value;
+    return ERROR_DIRECTIVE;
 }
 
 Opcode get_opcode(char *opcode_token)
 {
+    const Keyword *keyword = keyword_lookup(opcode_token);
 
     PRINT_DEBUG("getting opcode\n");
-    int res;
-    if (strcmp(opcode_token, "mov") == 0)
-        return 0;
-    if (strcmp(opcode_token, "cmp") == 0)
-        return 1;
-    if (strcmp(opcode_token, "add") == 0)
-        return 2;
-    if (strcmp(opcode_token, "sub") == 0)
-        return 3;
-    if (strcmp(opcode_token, "lea") == 0)
-        return 4;
-    if (strcmp(opcode_token, "clr") == 0)
-        return 5;
-    if (strcmp(opcode_token, "not") == 0)
-        return 6;
-    if (strcmp(opcode_token, "inc") == 0)
-        return 7;
-    if (strcmp(opcode_token, "dec") == 0)
-        return 8;
-    if (strcmp(opcode_token, "jmp") == 0)
-        return 9;
-    if (strcmp(opcode_token, "bne") == 0)
-        return 10;
-    if (strcmp(opcode_token, "red") == 0)
-        return 11;
-    if (strcmp(opcode_token, "prn") == 0)
-        return 12;
-    if (strcmp(opcode_token, "jsr") == 0)
-        return 13;
-    if (strcmp(opcode_token, "rts") == 0)
-        return 14;
-    if (strcmp(opcode_token, "stop") == 0)
-        return 15;
+    if (keyword && keyword->kind == KEYWORD_OPCODE)
+        return (Opcode)keyword->value;
     return -1;
 }
 
@@ -807,20 +776,20 @@ int is_instruction_line(char *leader)
 
 int is_comment_line(char *line)
 {
-    const char *trimmed;
+    char trimmed[MAX_LINE_LEN];
     if (!line)
         return 0;
-    trimmed = trim_whitespace(line);
+    trim_whitespace(line, trimmed, sizeof(trimmed));
     return trimmed[0] == ';';
 }
 
-int is_empty_line(Tokens tokens)
+int is_empty_line(const Tokens *tokens)
 {
-    const char *trimmed;
-    if (tokens.count == 0)
+    char trimmed[MAX_TOKEN_LEN];
+    if (tokens->count == 0)
         return 1;
 
-    trimmed = trim_whitespace(tokens.tokens[0]);
+    trim_whitespace(token_text(tokens, 0), trimmed, sizeof(trimmed));
     return trimmed[0] == '\0';
 }
 
@@ -874,12 +843,8 @@ int is_valid_label_name(char *token)
 
 int is_valid_directive_name(char *directive)
 {
-    char *dir_name = directive + 1;
-    return (strcmp(dir_name, "data") == 0 ||
-            strcmp(dir_name, "string") == 0 ||
-            strcmp(dir_name, "mat") == 0 ||
-            strcmp(dir_name, "entry") == 0 ||
-            strcmp(dir_name, "extern") == 0);
+    const Keyword *keyword = keyword_lookup(directive);
+    return keyword && keyword->kind == KEYWORD_DIRECTIVE;
 }
 
 int is_valid_number_operand(char *value)
@@ -890,12 +855,14 @@ int is_valid_number_operand(char *value)
 int is_valid_mat_access(char *value)
 {
     /* trimmed copy of value */
-    char *trimmed_value = trim_whitespace(value);
+    char trimmed_value[MAX_TOKEN_LEN];
     char temp[MAX_TOKEN_LEN];
     char temp_reg1[3];
     char temp_reg2[3];
     int i = 0;
 
+    trim_whitespace(value, trimmed_value, sizeof(trimmed_value));
+
     /* copy name, stop at opening '[' */
     while (i < MAX_TOKEN_LEN - 1 && trimmed_value[i] != '[')
     {
@@ -939,43 +906,23 @@ int is_valid_mat_access(char *value)
 
 int is_valid_register(char *value)
 {
-    /* TODO: hande unvalid register */
-    if (value[0] != 'r')
-        return 0;
-    if (value[1] < '0' || value[1] > '7')
-        return 0;
-    if (value[2] != '\0')
-        return 0;
-    return 1;
+    const Keyword *keyword = keyword_lookup(value);
+    return keyword && keyword->kind == KEYWORD_REGISTER;
 }
 
 int is_reserved_label_name(const char *s)
 {
-    /* list only what you actually use */
-    static const char *reserved[] = {
-        /* opcodes */
-        "mov:", "cmp:", "add:", "sub:", "lea:",
-        "not:", "clr:", "inc:", "dec:",
-        "jmp:", "bne:", "red:", "prn:", "jsr:",
-        "rts:", "stop:",
-        /* registers */
-        "r0:", "r1:", "r2:", "r3:", "r4:", "r5:", "r6:", "r7:",
-        /* macro keywords */
-        "mcro:", "mcroend:",
-        /* directives (both with and without dot if you want) */
-        ".data:", ".string:", ".mat:", ".entry:", ".extern:",
-        "data:", "string:", "mat:", "entry:", "extern:"};
-    size_t i, n = sizeof(reserved) / sizeof(reserved[0]);
+    /* s is a label declaration: any keyword (opcode, register, macro keyword,
+       directive with or without the dot) followed by ':' */
+    size_t len;
 
     if (!s || !*s)
         return 1; /* treat empty as bad */
 
-    for (i = 0; i < n; ++i)
-    {
-        if (strcmp(s, reserved[i]) == 0)
-            return 1;
-    }
-    return 0;
+    len = strlen(s);
+    if (s[len - 1] != ':')
+        return 0;
+    return keyword_lookup_span(s, len - 1) != NULL;
 }
 
 int ends_with_comma(const char *line)
@@ -1070,12 +1017,14 @@ int is_immediate_float_token(const char *tok)
 int is_mat_access(char *value)
 {
     /* trimmed copy of value */
-    char *trimmed_value = trim_whitespace(value);
+    char trimmed_value[MAX_TOKEN_LEN];
     char temp[MAX_TOKEN_LEN];
     char temp_reg1[3];
     char temp_reg2[3];
     int i = 0;
 
+    trim_whitespace(value, trimmed_value, sizeof(trimmed_value));
+
     /* copy name, stop at opening '[' */
     while (i < MAX_TOKEN_LEN - 1 && trimmed_value[i] != '[')
     {
@@ -1137,14 +1086,7 @@ const char *addressing_mode_name(AddressingMode mode)
     }
 }
 
-char *copy_label_token(char *token)
-{
-    char *copy = malloc(strlen(token) + 1);
-    strcpy(copy, token);
-    return copy;
-}
-
-void insert_entry_label(Table *ent_table, char *label, int address)
+void insert_entry_label(Table *ent_table, const char *label, int address)
 {
     int *addr = malloc(sizeof(int));
     if (!addr)
@@ -1157,7 +1099,7 @@ void insert_entry_label(Table *ent_table, char *label, int address)
     table_insert(ent_table, label, addr);
 }
 
-void insert_extern_label(Table *ext_table, char *label, int address)
+void insert_extern_label(Table *ext_table, const char *label, int address)
 {
 
     int *addr = malloc(sizeof(int));
@@ -11,10 +11,14 @@
 #include "../common/printer/printer.h"
 #include "../common/errors/errors.h"
 #include "../common/symbols/symbols.h"
+#include "../common/keywords/keywords.h"
 
-void run_first_pass(char *filename, Table *symbol_table, ASTNode **head, int *IC, EncodedList *encoded_list, StatusInfo *status_info);
-ASTNode *parse_instruction_line(int line_num, Tokens tokenized_line, int leader_idx);
-ASTNode *parse_directive_line(int line_num, Tokens tokenized_line, int leader_idx, int *DC_ptr);
+#include "../assembler/context.h"
+
+/* Parses and encodes <output_dir>/<base_name>.am, filling the context's symbol table, AST and encoded list */
+void run_first_pass(AssemblerContext *ctx);
+ASTNode *parse_instruction_line(Arena *arena, Interner *labels, int line_num, const Tokens *tokenized_line, int leader_idx);
+ASTNode *parse_directive_line(Arena *arena, int line_num, const Tokens *tokenized_line, int leader_idx, int *DC_ptr);
 int is_symbol_declare(char *token);
 int is_instruction_line(char *leader);
 int is_directive_line(char *leader);
@@ -27,12 +31,11 @@ int is_valid_mat_access(char *value);
 int is_valid_register(char *value);
 int is_valid_label_name(char *token);
 int is_comment_line(char *token);
-int is_empty_line(Tokens tokens);
+int is_empty_line(const Tokens *tokens);
 int is_reserved_label_name(const char *s);
 int ends_with_comma(const char *line);
-char *copy_label_token(char *token);
-void insert_entry_label(Table *ent_table, char *label, int address);
-void insert_extern_label(Table *ext_table, char *label, int address);
+void insert_entry_label(Table *ent_table, const char *label, int address);
+void insert_extern_label(Table *ext_table, const char *label, int address);
 void set_directive_flags(ASTNode *node, SymbolInfo *info);
 int is_valid_immediate_token(const char *tok);
 int is_in_bound_immediate_token(const char *tok);
@@ -44,6 +47,6 @@ Opcode get_opcode(char *str);
 
 const char *addressing_mode_name(AddressingMode mode);
 
-ErrorCode parse_instruction_operand(Operand *operand_to_parse, Tokens tokenized_line, int token_idx);
+ErrorCode parse_instruction_operand(Interner *labels, Operand *operand_to_parse, const Tokens *tokenized_line, int token_idx);
 
 #endif
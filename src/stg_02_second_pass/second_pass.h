@@ -8,7 +8,26 @@
 #include "../common/symbols/symbols.h"
 
 
-void run_second_pass(Table *symbol_table, ASTNode **ast_head,EncodedList *encoded_list, StatusInfo *status_info);
+#include "../assembler/context.h"
+
+/* Patches the label operand words of ctx->image using the symbol table */
+void run_second_pass(AssemblerContext *ctx);
+
+#define ADDRESS_DIGITS 4 /* base-4 digits of an address in the output files */
+#define WORD_DIGITS 5    /* base-4 digits of a machine word */
+#define OBJECT_ROW_LEN (ADDRESS_DIGITS + 1 + WORD_DIGITS + 1) /* "<address>\t<word>\n" */
+
+/* word conversions used when writing the output files, one table copy each */
+void addr_to_base4(unsigned char value, char out[5]);
+void bincode_to_base4(unsigned int value, char out[6]);
+void bincode_to_signed_base4(int value, char out[6]);
+
+/*
+ * Writes count .ob rows for words, the first one at address, into out
+ * (count * OBJECT_ROW_LEN bytes, not terminated). Code and data words share
+ * the format: a negative data word's low 10 bits are its two's complement.
+ */
+void format_object_rows(char *out, int address, const MachineWord *words, int count);
 
 
 #endif
\ No newline at end of file